@@ -5,10 +5,15 @@
 #include "redev.h"
 #include "redev_profile.h"
 #include "redev_exclusive_scan.h"
+#include "redev_trace.h"
+#include "redev_comm_matrix.h"
 #include <thread>         // std::this_thread::sleep_for
 #include <chrono>         // std::chrono::seconds
 #include <string>         // std::stoi
-#include <algorithm>      // std::find_if
+#include <algorithm>      // std::find_if, std::sort, std::inplace_merge
+#include <cstring>        // std::memcpy
+#include <cmath>          // std::floor, std::ldexp
+#include <utility>        // std::exchange
 
 namespace {
   //Wait for the file to be created by the writer.
@@ -26,6 +31,166 @@ namespace {
     // TODO: REDEV LOGGING...LOG INFO that sleeping for engine creation
     std::this_thread::sleep_for(std::chrono::seconds(2));
   }
+
+  //Spread the bits of a quantized coordinate so that the bits of the other
+  //Dim-1 coordinates can be interleaved between them (Morton encoding).
+  template <int Dim>
+  std::uint64_t spreadBits(std::uint64_t x) {
+    if constexpr (Dim == 1) {
+      return x;
+    } else if constexpr (Dim == 2) { //32 bits per axis
+      x &= 0x00000000ffffffffULL;
+      x = (x | (x << 16)) & 0x0000ffff0000ffffULL;
+      x = (x | (x << 8))  & 0x00ff00ff00ff00ffULL;
+      x = (x | (x << 4))  & 0x0f0f0f0f0f0f0f0fULL;
+      x = (x | (x << 2))  & 0x3333333333333333ULL;
+      x = (x | (x << 1))  & 0x5555555555555555ULL;
+      return x;
+    } else { //21 bits per axis
+      x &= 0x00000000001fffffULL;
+      x = (x | (x << 32)) & 0x001f00000000ffffULL;
+      x = (x | (x << 16)) & 0x001f0000ff0000ffULL;
+      x = (x | (x << 8))  & 0x100f00f00f00f00fULL;
+      x = (x | (x << 4))  & 0x10c30c30c30c30c3ULL;
+      x = (x | (x << 2))  & 0x1249249249249249ULL;
+      return x;
+    }
+  }
+
+  //Compute the Morton keys of 'numPts' points stored with a stride of three.
+  //The loop body has no branches so the compiler can vectorize it.
+  template <int Dim>
+  void mortonKeys(const redev::Real* pts, size_t numPts,
+      const std::array<redev::Real,3>& lo, const std::array<redev::Real,3>& scale,
+      redev::Real maxQ, redev::SFCPtn::Key* keys) {
+    const redev::Real zero = 0;
+    for(size_t n=0; n<numPts; n++) {
+      redev::SFCPtn::Key key = 0;
+      for(int d=0; d<Dim; d++) {
+        const auto q = std::min(std::max(std::floor((pts[3*n+d]-lo[d])*scale[d]), zero), maxQ);
+        key |= spreadBits<Dim>(static_cast<std::uint64_t>(q)) << d;
+      }
+      keys[n] = key;
+    }
+  }
+
+  void mortonKeys(int dim, int bits, const redev::Real* pts, size_t numPts,
+      const std::array<redev::Real,3>& lo, const std::array<redev::Real,3>& scale,
+      redev::SFCPtn::Key* keys) {
+    const auto maxQ = std::ldexp(redev::Real(1), bits) - 1;
+    switch(dim) {
+      case 1: mortonKeys<1>(pts, numPts, lo, scale, maxQ, keys); break;
+      case 2: mortonKeys<2>(pts, numPts, lo, scale, maxQ, keys); break;
+      case 3: mortonKeys<3>(pts, numPts, lo, scale, maxQ, keys); break;
+      default: redev::Redev_Assert_Fail("SFCPtn dimension must be in [1:3]\n");
+    }
+  }
+
+  /*
+   * return the owner of the point in the RCB cut tree of the given depth, the
+   * cut at depth lvl is normal to axis lvl%Dim
+   */
+  template <int Dim, typename T>
+  inline redev::LO rcbRank(const redev::Real* cuts, const redev::LO* ranks,
+      const int levels, const T* pt) {
+    std::size_t idx = 1;
+    int lvl = 0;
+    //descend Dim levels per iteration so the axis of each cut is a constant
+    for(; lvl+Dim <= levels; lvl += Dim) {
+      for(int d=0; d<Dim; d++)
+        idx = 2*idx + !(pt[d] < cuts[idx]);
+    }
+    for(int d=0; lvl < levels; lvl++, d++)
+      idx = 2*idx + !(pt[d] < cuts[idx]);
+    return ranks[idx - (std::size_t(1) << levels)];
+  }
+
+  template <int Dim, typename T>
+  void rcbRanks(const redev::Real* cuts, const redev::LO* ranks, const int levels,
+      const T* pts, redev::LOs& owners) {
+    for(std::size_t i=0; i<owners.size(); i++)
+      owners[i] = rcbRank<Dim>(cuts, ranks, levels, pts+3*i);
+  }
+
+  //ClassPtn table entry: (dim, id, rank)
+  const size_t entRankStride = 3;
+  using EntAndRank = std::array<redev::LO,3>;
+  static_assert(sizeof(EntAndRank) == entRankStride*sizeof(redev::LO));
+
+  const auto partitionTypeVarName = "redev partition type";
+  const auto partitionVersionVarName = "redev partition version";
+
+  /*
+   * define the variable the first time it is written and update its
+   * dimensions on later writes, i.e., when the partition is sent again after
+   * Redev::UpdatePartition
+   */
+  template <typename T>
+  adios2::Variable<T> defineVariable(adios2::IO& io, const std::string& name,
+      const adios2::Dims& shape = {}, const adios2::Dims& start = {},
+      const adios2::Dims& count = {}) {
+    auto var = io.InquireVariable<T>(name);
+    if(!var)
+      return io.DefineVariable<T>(name, shape, start, count);
+    if(!shape.empty())
+      var.SetShape(shape);
+    if(!count.empty())
+      var.SetSelection({start, count});
+    return var;
+  }
+
+  //mix the bits of a key so consecutive ids are spread over all ranks
+  std::uint64_t splitMix64(std::uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  //order table entries by their model entity (dim, id)
+  bool entLess(const EntAndRank& a, const EntAndRank& b) {
+    return a[0] < b[0] || (a[0] == b[0] && a[1] < b[1]);
+  }
+
+  /*
+   * sort the concatenation of the sorted (dim,id,rank) tables whose first
+   * entries start at runOffsets and remove duplicate entities
+   */
+  void mergeAndDedupe(redev::LOs& entsAndRanks, const redev::LOs& runOffsets) {
+    REDEV_FUNCTION_TIMER;
+    REDEV_ALWAYS_ASSERT(entsAndRanks.size()%entRankStride==0);
+    const auto numEnts = entsAndRanks.size()/entRankStride;
+    std::vector<EntAndRank> table(numEnts);
+    std::memcpy(table.data(), entsAndRanks.data(), entsAndRanks.size()*sizeof(redev::LO));
+    if(runOffsets.size() == 2) {
+      std::sort(table.begin(), table.end(), entLess);
+    } else {
+      //merge pairs of adjacent sorted runs until one run remains
+      auto bounds = runOffsets;
+      while(bounds.size() > 2) {
+        redev::LOs merged;
+        for(size_t i=0; i+2<bounds.size(); i+=2) {
+          std::inplace_merge(table.begin()+bounds[i], table.begin()+bounds[i+1],
+              table.begin()+bounds[i+2], entLess);
+          merged.push_back(bounds[i]);
+        }
+        if(bounds.size()%2 == 0) merged.push_back(bounds[bounds.size()-2]);
+        merged.push_back(bounds.back());
+        bounds = std::move(merged);
+      }
+    }
+    //an entity passed by more than one rank must have the same owner
+    size_t numUnique = 0;
+    for(size_t i=0; i<numEnts; i++) {
+      if(numUnique && !entLess(table[numUnique-1], table[i])) {
+        REDEV_ALWAYS_ASSERT(table[numUnique-1][2] == table[i][2]);
+        continue;
+      }
+      table[numUnique++] = table[i];
+    }
+    entsAndRanks.resize(numUnique*entRankStride);
+    std::memcpy(entsAndRanks.data(), table.data(), entsAndRanks.size()*sizeof(redev::LO));
+  }
 }
 
 namespace redev {
@@ -40,31 +205,35 @@ namespace redev {
     REDEV_ALWAYS_ASSERT(comm != MPI_COMM_NULL);
     assert(ranks_.size() == ents.size());
     if( ! ModelEntDimsValid(ents) ) exit(EXIT_FAILURE);
-    for(auto i=0; i<ranks_.size(); i++) {
-      modelEntToRank[ents[i]] = ranks_[i];
+    auto& table = entsAndRanks.Vector();
+    table.reserve(ents.size()*entRankStride);
+    for(size_t i=0; i<ents.size(); i++) {
+      table.push_back(ents[i].first);
+      table.push_back(ents[i].second);
+      table.push_back(ranks_[i]);
     }
-    Gather(comm);
+    //sort the local table so the gathered tables only need to be merged
+    mergeAndDedupe(table, {0, static_cast<redev::LO>(ents.size())});
+    AllGather(comm);
   }
 
-  void ClassPtn::Gather(MPI_Comm comm, int root) {
+  void ClassPtn::AllGather(MPI_Comm comm) {
     REDEV_FUNCTION_TIMER;
-    int rank, commSize;
-    MPI_Comm_rank(comm, &rank);
+    int commSize;
     MPI_Comm_size(comm, &commSize);
-    auto degree = !rank ? redev::LOs(commSize+1) : redev::LOs();
-    auto serialized = SerializeModelEntsAndRanks();
-    int len = static_cast<int>(serialized.size());
-    MPI_Gather(&len,1,MPI_INT,degree.data(),1,MPI_INT,root,comm);
-    if(root==rank) {
-      auto offset = redev::LOs(commSize+1);
-      redev::exclusive_scan(degree.begin(), degree.end(), offset.begin(), redev::LO(0));
-      auto allSerialized = redev::LOs(offset.back());
-      MPI_Gatherv(serialized.data(), len, MPI_INT, allSerialized.data(),
-          degree.data(), offset.data(), MPI_INT, root, comm);
-      modelEntToRank = DeserializeModelEntsAndRanks(allSerialized);
-    } else {
-      MPI_Gatherv(serialized.data(), len, MPI_INT, NULL, NULL, NULL, MPI_INT, root, comm);
-    }
+    auto& table = entsAndRanks.Vector();
+    int len = static_cast<int>(table.size());
+    auto degree = redev::LOs(commSize);
+    MPI_Allgather(&len,1,MPI_INT,degree.data(),1,MPI_INT,comm);
+    auto offset = redev::LOs(commSize+1);
+    redev::exclusive_scan(degree.begin(), degree.end(), offset.begin(), redev::LO(0));
+    offset.back() = offset[commSize-1] + degree[commSize-1];
+    auto allEntsAndRanks = redev::LOs(offset.back());
+    MPI_Allgatherv(table.data(), len, MPI_INT, allEntsAndRanks.data(),
+        degree.data(), offset.data(), MPI_INT, comm);
+    table = std::move(allEntsAndRanks);
+    for(auto& o : offset) o /= entRankStride;
+    mergeAndDedupe(table, offset);
   }
 
   bool ClassPtn::ModelEntDimsValid(const ClassPtn::ModelEntVec& ents) const {
@@ -81,80 +250,59 @@ namespace redev {
   }
 
   redev::LO ClassPtn::GetRank(ModelEnt ent) const {
-    REDEV_FUNCTION_TIMER;
+    REDEV_HOT_TIMER;
     REDEV_ALWAYS_ASSERT(ent.first>=0 && ent.first <=3); //check for valid dimension
-    assert(modelEntToRank.size());
-    assert(modelEntToRank.count(ent));
-    return modelEntToRank.at(ent);
+    REDEV_ALWAYS_ASSERT(entsAndRanks.size());
+    const EntAndRank key{ent.first, ent.second, 0};
+    const auto table = reinterpret_cast<const EntAndRank*>(entsAndRanks.data());
+    const auto numEnts = entsAndRanks.size()/entRankStride;
+    const auto found = std::lower_bound(table, table+numEnts, key, entLess);
+    REDEV_ALWAYS_ASSERT(found != table+numEnts && !entLess(key, *found)); //unknown entity
+    return (*found)[2];
   }
 
   redev::LOs ClassPtn::GetRanks() const {
     REDEV_FUNCTION_TIMER;
-    redev::LOs ranks(modelEntToRank.size());
-    int i=0;
-    for(const auto& iter : modelEntToRank) {
-      ranks[i++]=iter.second;
+    redev::LOs ranks(entsAndRanks.size()/entRankStride);
+    for(size_t i=0; i<ranks.size(); i++) {
+      ranks[i]=entsAndRanks[i*entRankStride+2];
     }
     return ranks;
   }
 
   ClassPtn::ModelEntVec ClassPtn::GetModelEnts() const {
     REDEV_FUNCTION_TIMER;
-    ModelEntVec ents(modelEntToRank.size());
-    int i=0;
-    for(const auto& iter : modelEntToRank) {
-      ents[i++]=iter.first;
+    ModelEntVec ents(entsAndRanks.size()/entRankStride);
+    for(size_t i=0; i<ents.size(); i++) {
+      ents[i]={entsAndRanks[i*entRankStride], entsAndRanks[i*entRankStride+1]};
     }
     return ents;
   }
 
-  redev::LOs ClassPtn::SerializeModelEntsAndRanks() const {
-    REDEV_FUNCTION_TIMER;
-    const auto stride = 3;
-    const auto numEnts = modelEntToRank.size();
-    redev::LOs entsAndRanks;
-    entsAndRanks.reserve(numEnts*stride);
-    for(const auto& iter : modelEntToRank) {
-      auto ent = iter.first;
-      entsAndRanks.push_back(ent.first);   //dim
-      entsAndRanks.push_back(ent.second);  //id
-      entsAndRanks.push_back(iter.second); //rank
-    }
-    REDEV_ALWAYS_ASSERT(entsAndRanks.size()==numEnts*stride);
-    return entsAndRanks;
-  }
-
-  ClassPtn::ModelEntToRank ClassPtn::DeserializeModelEntsAndRanks(const redev::LOs& serialized) const {
-    REDEV_FUNCTION_TIMER;
-    const auto stride = 3;
-    REDEV_ALWAYS_ASSERT(serialized.size()%stride==0);
-    ModelEntToRank me2r;
-    for(size_t i=0; i<serialized.size(); i+=stride) {
-      const auto dim=serialized[i];
-      REDEV_ALWAYS_ASSERT(dim>=0 && dim<=3);
-      const auto id=serialized[i+1];
-      const auto rank=serialized[i+2];
-      ModelEnt ent(dim,id);
-      const auto hasEnt = me2r.count(ent);
-      if( !hasEnt ) {
-        me2r[ent] = rank;
-      } else {
-        REDEV_ALWAYS_ASSERT(rank == me2r[ent]);
-      }
-    }
-    return me2r;
-  }
-
   void ClassPtn::Write(adios2::Engine& eng, adios2::IO& io) {
     REDEV_FUNCTION_TIMER;
-    auto serialized = SerializeModelEntsAndRanks();
-    const auto len = serialized.size();
-    auto entsAndRanksVar = io.DefineVariable<redev::LO>(entsAndRanksVarName,{},{},{len});
-    eng.Put(entsAndRanksVar, serialized.data());
+    const auto len = entsAndRanks.size();
+    auto entsAndRanksVar = defineVariable<redev::LO>(io, entsAndRanksVarName,{},{},{len});
+    eng.Put(entsAndRanksVar, entsAndRanks.data());
     eng.PerformPuts();
   }
 
   void ClassPtn::Read(adios2::Engine& eng, adios2::IO& io) {
+    REDEV_FUNCTION_TIMER;
+    entsAndRanks.Vector() = ReadTable(eng, io);
+  }
+
+  void ClassPtn::ReadNodeShared(adios2::Engine& eng, adios2::IO& io, MPI_Comm comm, int root) {
+    REDEV_FUNCTION_TIMER;
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    redev::LOs values;
+    if(rank == root)
+      values = ReadTable(eng, io);
+    entsAndRanks.Assign(comm, root, std::move(values));
+  }
+
+  redev::LOs ClassPtn::ReadTable(adios2::Engine& eng, adios2::IO& io) const {
     REDEV_FUNCTION_TIMER;
     const auto step = eng.CurrentStep();
     auto entsAndRanksVar = io.InquireVariable<redev::LO>(entsAndRanksVarName);
@@ -163,29 +311,223 @@ namespace redev {
     auto blocksInfo = eng.BlocksInfo(entsAndRanksVar,step);
     assert(blocksInfo.size()==1);
     entsAndRanksVar.SetBlockSelection(blocksInfo[0].BlockID);
-    redev::LOs serialized;
-    eng.Get(entsAndRanksVar, serialized);
+    redev::LOs values;
+    eng.Get(entsAndRanksVar, values);
     eng.PerformGets(); //default read mode is deferred
-
-    modelEntToRank = DeserializeModelEntsAndRanks(serialized);
+    //the writer sends a sorted table, mergeAndDedupe is only needed to
+    //support tables that were not created by ClassPtn
+    REDEV_ALWAYS_ASSERT(values.size()%entRankStride==0);
+    const auto table = reinterpret_cast<const EntAndRank*>(values.data());
+    const auto numEnts = values.size()/entRankStride;
+    if(std::adjacent_find(table, table+numEnts,
+          [](const EntAndRank& a, const EntAndRank& b) { return !entLess(a,b); })
+        != table+numEnts) {
+      mergeAndDedupe(values, {0, static_cast<redev::LO>(numEnts)});
+    }
+    return values;
   }
 
   void ClassPtn::Broadcast(MPI_Comm comm, int root) {
     REDEV_FUNCTION_TIMER;
+    entsAndRanks.Broadcast(comm, root);
+  }
+
+  void ClassPtn::BroadcastNodeShared(MPI_Comm comm, int root) {
+    REDEV_FUNCTION_TIMER;
+    entsAndRanks.BroadcastNodeShared(comm, root);
+  }
+
+
+  DistributedClassPtn::DistributedClassPtn() {
+    REDEV_FUNCTION_TIMER;
+  }
+
+  DistributedClassPtn::DistributedClassPtn(MPI_Comm comm_, const redev::LOs& ranks_,
+      const ModelEntVec& ents) : comm(comm_) {
+    REDEV_FUNCTION_TIMER;
+    REDEV_ALWAYS_ASSERT(comm != MPI_COMM_NULL);
+    REDEV_ALWAYS_ASSERT(ranks_.size() == ents.size());
+    MPI_Comm_size(comm, &commSize);
+    redev::LOs triples;
+    triples.reserve(ents.size()*entRankStride);
+    for(size_t i=0; i<ents.size(); i++) {
+      REDEV_ALWAYS_ASSERT(ents[i].first>=0 && ents[i].first<=3);
+      triples.push_back(ents[i].first);
+      triples.push_back(ents[i].second);
+      triples.push_back(ranks_[i]);
+    }
+    Distribute(triples);
+  }
+
+  int DistributedClassPtn::StoringRank(ModelEnt ent) const {
+    const auto key = (static_cast<std::uint64_t>(ent.first) << 32) |
+                     static_cast<std::uint32_t>(ent.second);
+    return static_cast<int>(splitMix64(key) % static_cast<std::uint64_t>(commSize));
+  }
+
+  void DistributedClassPtn::Distribute(const redev::LOs& triples) {
+    REDEV_FUNCTION_TIMER;
+    const auto numTriples = triples.size()/entRankStride;
+    redev::LOs sendCounts(commSize,0);
+    std::vector<int> dest(numTriples);
+    for(size_t i=0; i<numTriples; i++) {
+      dest[i] = StoringRank({triples[i*entRankStride], triples[i*entRankStride+1]});
+      sendCounts[dest[i]] += entRankStride;
+    }
+    redev::LOs sendOffsets(commSize);
+    redev::exclusive_scan(sendCounts.begin(), sendCounts.end(), sendOffsets.begin(), redev::LO(0));
+    redev::LOs sendBuf(triples.size());
+    auto pos = sendOffsets;
+    for(size_t i=0; i<numTriples; i++) {
+      std::copy_n(triples.begin()+i*entRankStride, entRankStride, sendBuf.begin()+pos[dest[i]]);
+      pos[dest[i]] += entRankStride;
+    }
+    redev::LOs recvCounts(commSize);
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm);
+    redev::LOs recvOffsets(commSize);
+    redev::exclusive_scan(recvCounts.begin(), recvCounts.end(), recvOffsets.begin(), redev::LO(0));
+    entsAndRanks.resize(recvOffsets.back()+recvCounts.back());
+    MPI_Alltoallv(sendBuf.data(), sendCounts.data(), sendOffsets.data(), MPI_INT,
+        entsAndRanks.data(), recvCounts.data(), recvOffsets.data(), MPI_INT, comm);
+    mergeAndDedupe(entsAndRanks, {0, static_cast<redev::LO>(entsAndRanks.size()/entRankStride)});
+    cacheList.clear();
+    cacheIndex.clear();
+  }
+
+  redev::LO DistributedClassPtn::LocalRank(ModelEnt ent) const {
+    const EntAndRank key{ent.first, ent.second, 0};
+    const auto table = reinterpret_cast<const EntAndRank*>(entsAndRanks.data());
+    const auto numEnts = entsAndRanks.size()/entRankStride;
+    const auto found = std::lower_bound(table, table+numEnts, key, entLess);
+    REDEV_ALWAYS_ASSERT(found != table+numEnts && !entLess(key, *found));
+    return (*found)[2];
+  }
+
+  redev::LOs DistributedClassPtn::GetRanks(const ModelEntVec& ents) const {
+    REDEV_FUNCTION_TIMER;
+    REDEV_ALWAYS_ASSERT(comm != MPI_COMM_NULL);
+    redev::LOs owners(ents.size(), -1);
+    //answer what we can from the cache and count the remaining queries
+    std::vector<size_t> misses;
+    std::vector<int> dest;
+    redev::LOs sendCounts(commSize,0);
+    for(size_t i=0; i<ents.size(); i++) {
+      if(cacheCapacity) {
+        auto hit = cacheIndex.find(ents[i]);
+        if(hit != cacheIndex.end()) {
+          cacheList.splice(cacheList.begin(), cacheList, hit->second);
+          owners[i] = hit->second->second;
+          continue;
+        }
+      }
+      misses.push_back(i);
+      dest.push_back(StoringRank(ents[i]));
+      sendCounts[dest.back()] += 2;
+    }
+    redev::LOs sendOffsets(commSize);
+    redev::exclusive_scan(sendCounts.begin(), sendCounts.end(), sendOffsets.begin(), redev::LO(0));
+    redev::LOs query(misses.size()*2);
+    std::vector<size_t> queryPos(misses.size());
+    auto pos = sendOffsets;
+    for(size_t i=0; i<misses.size(); i++) {
+      queryPos[i] = pos[dest[i]]/2;
+      query[pos[dest[i]]] = ents[misses[i]].first;
+      query[pos[dest[i]]+1] = ents[misses[i]].second;
+      pos[dest[i]] += 2;
+    }
+    redev::LOs recvCounts(commSize);
+    MPI_Alltoall(sendCounts.data(), 1, MPI_INT, recvCounts.data(), 1, MPI_INT, comm);
+    redev::LOs recvOffsets(commSize);
+    redev::exclusive_scan(recvCounts.begin(), recvCounts.end(), recvOffsets.begin(), redev::LO(0));
+    redev::LOs received(recvOffsets.back()+recvCounts.back());
+    MPI_Alltoallv(query.data(), sendCounts.data(), sendOffsets.data(), MPI_INT,
+        received.data(), recvCounts.data(), recvOffsets.data(), MPI_INT, comm);
+    //answer the received queries, one rank per entity
+    redev::LOs answers(received.size()/2);
+    for(size_t i=0; i<answers.size(); i++)
+      answers[i] = LocalRank({received[i*2], received[i*2+1]});
+    for(int i=0; i<commSize; i++) {
+      sendCounts[i] /= 2; sendOffsets[i] /= 2;
+      recvCounts[i] /= 2; recvOffsets[i] /= 2;
+    }
+    redev::LOs replies(misses.size());
+    MPI_Alltoallv(answers.data(), recvCounts.data(), recvOffsets.data(), MPI_INT,
+        replies.data(), sendCounts.data(), sendOffsets.data(), MPI_INT, comm);
+    for(size_t i=0; i<misses.size(); i++) {
+      const auto owner = replies[queryPos[i]];
+      owners[misses[i]] = owner;
+      if(cacheCapacity && !cacheIndex.count(ents[misses[i]])) {
+        cacheList.emplace_front(ents[misses[i]], owner);
+        cacheIndex[ents[misses[i]]] = cacheList.begin();
+        if(cacheList.size() > cacheCapacity) {
+          cacheIndex.erase(cacheList.back().first);
+          cacheList.pop_back();
+        }
+      }
+    }
+    return owners;
+  }
+
+  void DistributedClassPtn::SetCacheCapacity(std::size_t capacity) {
+    REDEV_FUNCTION_TIMER;
+    cacheCapacity = capacity;
+    while(cacheList.size() > cacheCapacity) {
+      cacheIndex.erase(cacheList.back().first);
+      cacheList.pop_back();
+    }
+  }
+
+  std::size_t DistributedClassPtn::GetCacheCapacity() const noexcept {
+    return cacheCapacity;
+  }
+
+  std::size_t DistributedClassPtn::GetLocalSize() const noexcept {
+    return entsAndRanks.size()/entRankStride;
+  }
+
+  void DistributedClassPtn::Write(adios2::Engine& eng, adios2::IO& io, MPI_Comm comm_) {
+    REDEV_FUNCTION_TIMER;
+    std::size_t len = entsAndRanks.size();
+    std::size_t offset = 0;
+    std::size_t total = 0;
+    MPI_Exscan(&len, &offset, 1, getMpiType(len), MPI_SUM, comm_);
+    MPI_Allreduce(&len, &total, 1, getMpiType(len), MPI_SUM, comm_);
+    int rank;
+    MPI_Comm_rank(comm_, &rank);
+    if(!rank) offset = 0; //MPI_Exscan leaves the result on rank 0 undefined
+    auto var = defineVariable<redev::LO>(io, entsAndRanksVarName, {total}, {offset}, {len});
+    if(len)
+      eng.Put(var, entsAndRanks.data());
+    eng.PerformPuts();
+  }
+
+  void DistributedClassPtn::Read(adios2::Engine& eng, adios2::IO& io, MPI_Comm comm_) {
+    REDEV_FUNCTION_TIMER;
+    comm = comm_;
+    REDEV_ALWAYS_ASSERT(comm != MPI_COMM_NULL);
+    MPI_Comm_size(comm, &commSize);
     int rank;
     MPI_Comm_rank(comm, &rank);
-    auto serialized = SerializeModelEntsAndRanks();
-    int len = static_cast<int>(serialized.size());
-    redev::Broadcast(&len, 1, root, comm);
-    if(root != rank) {
-      serialized.resize(len);
-    }
-    redev::Broadcast(serialized.data(), serialized.size(), root, comm);
-    if(root != rank) {
-      modelEntToRank = DeserializeModelEntsAndRanks(serialized);
+    auto var = io.InquireVariable<redev::LO>(entsAndRanksVarName);
+    REDEV_ALWAYS_ASSERT(var);
+    const auto shape = var.Shape();
+    REDEV_ALWAYS_ASSERT(shape.size() == 1);
+    //read an even number of the triples then send them to the ranks storing them
+    const auto numTriples = shape[0]/entRankStride;
+    const auto first = numTriples*rank/commSize;
+    const auto last = numTriples*(rank+1)/commSize;
+    redev::LOs triples((last-first)*entRankStride);
+    if(!triples.empty()) {
+      var.SetSelection({{first*entRankStride}, {triples.size()}});
+      eng.Get(var, triples.data());
+      eng.PerformGets();
     }
+    Distribute(triples);
   }
 
+  void DistributedClassPtn::Broadcast(MPI_Comm, int) {
+    REDEV_FUNCTION_TIMER;
+  }
 
   //TODO consider moving the RCBPtn source to another file
   RCBPtn::RCBPtn() {
@@ -202,38 +544,128 @@ namespace redev {
     : dim(dim_), ranks(ranks_), cuts(cuts_) {
     REDEV_FUNCTION_TIMER;
     assert(dim>0 && dim<=3);
+    Init();
+  }
+
+  void RCBPtn::Init() {
+    const size_t len = cuts.size();
+    levels = 0;
+    while(levels < 64 && (size_t(1) << levels) < len) ++levels;
+    //other sizes are accepted, e.g., placeholder partitions with one cut per
+    //rank that are never queried, see CheckTree
+    if(levels == 64 || len != (size_t(1) << levels) || ranks.size() != len)
+      levels = -1;
+  }
+
+  void RCBPtn::CheckTree() const {
+    REDEV_ALWAYS_ASSERT(ranks.size() && cuts.size());
+    if(levels < 0)
+      redev::Redev_Assert_Fail("RCBPtn queries need the same power of two number of ranks and cuts\n");
   }
 
   redev::LO RCBPtn::GetRank(std::array<redev::Real,3>& pt) const { //TODO better name?
+    REDEV_HOT_TIMER;
+    CheckTree();
+    assert(dim>0 && dim<=3);
+    switch(dim) {
+      case 1: return rcbRank<1>(cuts.data(), ranks.data(), levels, pt.data());
+      case 2: return rcbRank<2>(cuts.data(), ranks.data(), levels, pt.data());
+      case 3: return rcbRank<3>(cuts.data(), ranks.data(), levels, pt.data());
+      default: redev::Redev_Assert_Fail("RCBPtn dimension must be in [1:3]\n");
+    }
+    return -1;
+  }
+
+  template <typename T>
+  redev::LOs RCBPtn::GetRankBatch(const std::vector<T>& pts) const {
+    REDEV_FUNCTION_TIMER;
+    CheckTree();
+    REDEV_ALWAYS_ASSERT(pts.size() % 3 == 0);
+    redev::LOs owners(pts.size()/3);
+    switch(dim) {
+      case 1: rcbRanks<1>(cuts.data(), ranks.data(), levels, pts.data(), owners); break;
+      case 2: rcbRanks<2>(cuts.data(), ranks.data(), levels, pts.data(), owners); break;
+      case 3: rcbRanks<3>(cuts.data(), ranks.data(), levels, pts.data(), owners); break;
+      default: redev::Redev_Assert_Fail("RCBPtn dimension must be in [1:3]\n");
+    }
+    return owners;
+  }
+
+  redev::LOs RCBPtn::GetRank(const redev::Reals& pts) const {
+    return GetRankBatch(pts);
+  }
+
+  redev::LOs RCBPtn::GetRank(const std::vector<float>& pts) const {
+    return GetRankBatch(pts);
+  }
+
+  void RCBPtn::AppendLeafRanks(const redev::Real* boxMin, const redev::Real* boxMax,
+      redev::LOs& boxRanks) const {
+    CheckTree();
+    //depth first traversal of the implicit tree, the children of node idx are
+    //2*idx and 2*idx+1 and the cut at depth lvl is normal to axis lvl%dim
+    std::array<std::pair<size_t,int>, 64> stack;
+    int top = 0;
+    stack[top++] = {1,0};
+    while(top) {
+      const auto [idx, lvl] = stack[--top];
+      if(lvl == levels) {
+        boxRanks.push_back(ranks[idx - (size_t(1) << levels)]);
+        continue;
+      }
+      const auto d = lvl % dim;
+      const auto cut = cuts[idx];
+      //push the upper child first so the lower child is visited first
+      if(boxMax[d] >= cut) stack[top++] = {2*idx+1, lvl+1};
+      if(boxMin[d] < cut) stack[top++] = {2*idx, lvl+1};
+    }
+  }
+
+  redev::LOs RCBPtn::GetRanks(const std::array<redev::Real,3>& boxMin,
+      const std::array<redev::Real,3>& boxMax) const {
     REDEV_FUNCTION_TIMER;
     assert(ranks.size() && cuts.size());
-    assert(dim>0 && dim<=3);
-    const auto len = cuts.size();
-    const auto levels = std::log2(len);
-    auto lvl = 0;
-    auto idx = 1;
-    auto d = 0;
-    while(lvl < levels) {
-      if(pt[d]<cuts.at(idx))
-        idx = idx*2;
-      else
-        idx = idx*2+1;
-      ++lvl;
-      d = (d + 1) % dim;
-    }
-    auto rankIdx = idx-std::pow(2,lvl);
-    assert(rankIdx < ranks.size());
-    return ranks.at(rankIdx);
+    for(int d=0; d<dim; d++)
+      REDEV_ALWAYS_ASSERT(boxMin[d] <= boxMax[d]);
+    redev::LOs boxRanks;
+    AppendLeafRanks(boxMin.data(), boxMax.data(), boxRanks);
+    std::sort(boxRanks.begin(), boxRanks.end());
+    boxRanks.erase(std::unique(boxRanks.begin(), boxRanks.end()), boxRanks.end());
+    return boxRanks;
+  }
+
+  RCBPtn::BoxRanks RCBPtn::GetRanks(const redev::Reals& boxMins,
+      const redev::Reals& boxMaxs) const {
+    REDEV_FUNCTION_TIMER;
+    assert(ranks.size() && cuts.size());
+    REDEV_ALWAYS_ASSERT(boxMins.size() == boxMaxs.size());
+    REDEV_ALWAYS_ASSERT(boxMins.size() % 3 == 0);
+    const auto numBoxes = boxMins.size()/3;
+    BoxRanks out;
+    out.offsets.resize(numBoxes+1);
+    out.offsets[0] = 0;
+    for(size_t i=0; i<numBoxes; i++) {
+      const auto boxMin = boxMins.data()+3*i;
+      const auto boxMax = boxMaxs.data()+3*i;
+      for(int d=0; d<dim; d++)
+        REDEV_ALWAYS_ASSERT(boxMin[d] <= boxMax[d]);
+      const auto first = out.ranks.size();
+      AppendLeafRanks(boxMin, boxMax, out.ranks);
+      std::sort(out.ranks.begin()+first, out.ranks.end());
+      out.ranks.erase(std::unique(out.ranks.begin()+first, out.ranks.end()), out.ranks.end());
+      out.offsets[i+1] = static_cast<redev::LO>(out.ranks.size());
+    }
+    return out;
   }
 
   std::vector<redev::LO> RCBPtn::GetRanks() const {
     REDEV_FUNCTION_TIMER;
-    return ranks;
+    return ranks.ToVector();
   }
 
   std::vector<redev::Real> RCBPtn::GetCuts() const {
     REDEV_FUNCTION_TIMER;
-    return cuts;
+    return cuts.ToVector();
   }
 
   void RCBPtn::Write(adios2::Engine& eng, adios2::IO& io) {
@@ -241,9 +673,9 @@ namespace redev {
     const auto len = ranks.size();
     if(!len) return; //don't attempt zero length write
     assert(len==cuts.size());
-    auto ranksVar = io.DefineVariable<redev::LO>(ranksVarName,{},{},{len});
-    auto cutsVar = io.DefineVariable<redev::Real>(cutsVarName,{},{},{len});
-    auto dimVar = io.DefineVariable<redev::LO>(dimVarName);
+    auto ranksVar = defineVariable<redev::LO>(io, ranksVarName,{},{},{len});
+    auto cutsVar = defineVariable<redev::Real>(io, cutsVarName,{},{},{len});
+    auto dimVar = defineVariable<redev::LO>(io, dimVarName);
     eng.Put(ranksVar, ranks.data());
     eng.Put(cutsVar, cuts.data());
     eng.Put(dimVar, dim);
@@ -252,6 +684,27 @@ namespace redev {
 
   void RCBPtn::Read(adios2::Engine& eng, adios2::IO& io) {
     REDEV_FUNCTION_TIMER;
+    ReadTree(eng, io, ranks.Vector(), cuts.Vector());
+    Init();
+  }
+
+  void RCBPtn::ReadNodeShared(adios2::Engine& eng, adios2::IO& io, MPI_Comm comm, int root) {
+    REDEV_FUNCTION_TIMER;
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    redev::LOs ranks_;
+    redev::Reals cuts_;
+    if(rank == root)
+      ReadTree(eng, io, ranks_, cuts_);
+    redev::Broadcast(&dim, 1, root, comm);
+    ranks.Assign(comm, root, std::move(ranks_));
+    cuts.Assign(comm, root, std::move(cuts_));
+    Init();
+  }
+
+  void RCBPtn::ReadTree(adios2::Engine& eng, adios2::IO& io,
+      redev::LOs& ranks_, redev::Reals& cuts_) {
+    REDEV_FUNCTION_TIMER;
     const auto step = eng.CurrentStep();
     auto ranksVar = io.InquireVariable<redev::LO>(ranksVarName);
     auto cutsVar = io.InquireVariable<redev::Real>(cutsVarName);
@@ -262,29 +715,399 @@ namespace redev {
     auto blocksInfo = eng.BlocksInfo(ranksVar,step);
     assert(blocksInfo.size()==1);
     ranksVar.SetBlockSelection(blocksInfo[0].BlockID);
-    eng.Get(ranksVar, ranks);
+    eng.Get(ranksVar, ranks_);
 
     auto blockscutsInfo = eng.BlocksInfo(cutsVar,step);
     assert(blockscutsInfo.size()==1);
     cutsVar.SetBlockSelection(blockscutsInfo[0].BlockID);
-    eng.Get(cutsVar, cuts);
+    eng.Get(cutsVar, cuts_);
 
     eng.Get(dimVar, dim);
     eng.PerformGets(); //default read mode is deferred
   }
 
   void RCBPtn::Broadcast(MPI_Comm comm, int root) {
+    REDEV_FUNCTION_TIMER;
+    redev::Broadcast(&dim, 1, root, comm);
+    ranks.Broadcast(comm, root);
+    cuts.Broadcast(comm, root);
+    Init();
+  }
+
+  void RCBPtn::BroadcastNodeShared(MPI_Comm comm, int root) {
+    REDEV_FUNCTION_TIMER;
+    redev::Broadcast(&dim, 1, root, comm);
+    ranks.BroadcastNodeShared(comm, root);
+    cuts.BroadcastNodeShared(comm, root);
+    Init();
+  }
+
+  GridPtn::GridPtn()
+    : dim(0), origin{0,0,0}, spacing{1,1,1}, invSpacing{1,1,1}, cells{1,1,1} {
+    REDEV_FUNCTION_TIMER;
+  }
+
+  GridPtn::GridPtn(redev::LO dim_, const std::array<redev::Real,3>& origin_,
+      const std::array<redev::Real,3>& spacing_,
+      const std::array<redev::LO,3>& cells_, const redev::LOs& ranks_)
+    : dim(dim_), origin(origin_), spacing(spacing_), cells(cells_), ranks(ranks_) {
+    REDEV_FUNCTION_TIMER;
+    REDEV_ALWAYS_ASSERT(dim>0 && dim<=3);
+    for(int d=0; d<dim; d++) {
+      REDEV_ALWAYS_ASSERT(cells[d]>0);
+      REDEV_ALWAYS_ASSERT(spacing[d]>0);
+    }
+    Init();
+    REDEV_ALWAYS_ASSERT(ranks.size() == static_cast<size_t>(cells[0])*cells[1]*cells[2]);
+  }
+
+  void GridPtn::Init() {
+    for(int d=0; d<3; d++) {
+      if(d>=dim) {
+        origin[d] = 0;
+        spacing[d] = 1;
+        cells[d] = 1;
+      }
+      invSpacing[d] = 1.0/spacing[d];
+    }
+  }
+
+  redev::LO GridPtn::CellIndex(redev::Real x, int d) const {
+    //clamp in floating point so out of range points, and values that would
+    //overflow the integer conversion, map to the boundary cells; zero is the
+    //first argument of max so a NaN on an ignored axis maps to cell 0
+    auto c = std::floor((x-origin[d])*invSpacing[d]);
+    c = std::min(std::max(redev::Real(0), c), static_cast<redev::Real>(cells[d]-1));
+    return static_cast<redev::LO>(c);
+  }
+
+  redev::LO GridPtn::GetRank(const std::array<redev::Real,3>& pt) const {
+    REDEV_HOT_TIMER;
+    assert(ranks.size());
+    for(int d=0; d<dim; d++)
+      REDEV_ALWAYS_ASSERT(std::isfinite(pt[d]));
+    const auto i = CellIndex(pt[0],0);
+    const auto j = CellIndex(pt[1],1);
+    const auto k = CellIndex(pt[2],2);
+    return ranks[i + cells[0]*(j + cells[1]*k)];
+  }
+
+  redev::LOs GridPtn::GetRank(const redev::Reals& pts) const {
+    REDEV_FUNCTION_TIMER;
+    assert(ranks.size());
+    REDEV_ALWAYS_ASSERT(pts.size()%3 == 0);
+    const auto numPts = pts.size()/3;
+    redev::LOs owners(numPts);
+    //first pass: compute the cell id of each point; there are no branches or
+    //indirect loads so the compiler can vectorize it
+    const auto ox = origin[0], oy = origin[1], oz = origin[2];
+    const auto sx = invSpacing[0], sy = invSpacing[1], sz = invSpacing[2];
+    const auto mx = static_cast<redev::Real>(cells[0]-1);
+    const auto my = static_cast<redev::Real>(cells[1]-1);
+    const auto mz = static_cast<redev::Real>(cells[2]-1);
+    const auto nx = cells[0], nxy = cells[0]*cells[1];
+    const redev::Real zero = 0;
+    const bool ignoreY = dim < 2, ignoreZ = dim < 3;
+    const auto p = pts.data();
+    auto o = owners.data();
+    bool finite = true;
+    for(size_t n=0; n<numPts; n++) {
+      finite &= std::isfinite(p[3*n]) & (ignoreY | std::isfinite(p[3*n+1])) &
+                (ignoreZ | std::isfinite(p[3*n+2]));
+      //zero is the first argument of max so NaN maps to cell 0, see CellIndex
+      const auto i = std::min(std::max(zero, std::floor((p[3*n]-ox)*sx)), mx);
+      const auto j = std::min(std::max(zero, std::floor((p[3*n+1]-oy)*sy)), my);
+      const auto k = std::min(std::max(zero, std::floor((p[3*n+2]-oz)*sz)), mz);
+      o[n] = static_cast<redev::LO>(i) + nx*static_cast<redev::LO>(j) +
+             nxy*static_cast<redev::LO>(k);
+    }
+    REDEV_ALWAYS_ASSERT(finite);
+    //second pass: gather the owner of each cell
+    const auto r = ranks.data();
+    for(size_t n=0; n<numPts; n++) {
+      o[n] = r[o[n]];
+    }
+    return owners;
+  }
+
+  redev::LOs GridPtn::GetRanks() const {
+    REDEV_FUNCTION_TIMER;
+    return ranks;
+  }
+
+  std::array<redev::Real,3> GridPtn::GetOrigin() const {
+    REDEV_FUNCTION_TIMER;
+    return origin;
+  }
+
+  std::array<redev::Real,3> GridPtn::GetSpacing() const {
+    REDEV_FUNCTION_TIMER;
+    return spacing;
+  }
+
+  std::array<redev::LO,3> GridPtn::GetCells() const {
+    REDEV_FUNCTION_TIMER;
+    return cells;
+  }
+
+  void GridPtn::Write(adios2::Engine& eng, adios2::IO& io) {
+    REDEV_FUNCTION_TIMER;
+    const auto len = ranks.size();
+    if(!len) return; //don't attempt zero length write
+    auto ranksVar = defineVariable<redev::LO>(io, ranksVarName,{},{},{len});
+    auto geomVar = defineVariable<redev::Real>(io, geomVarName,{},{},{6});
+    auto cellsVar = defineVariable<redev::LO>(io, cellsVarName,{},{},{3});
+    auto dimVar = defineVariable<redev::LO>(io, dimVarName);
+    const redev::Reals geom{origin[0],origin[1],origin[2],
+                            spacing[0],spacing[1],spacing[2]};
+    eng.Put(ranksVar, ranks.data());
+    eng.Put(geomVar, geom.data());
+    eng.Put(cellsVar, cells.data());
+    eng.Put(dimVar, dim);
+    eng.PerformPuts();
+  }
+
+  void GridPtn::Read(adios2::Engine& eng, adios2::IO& io) {
+    REDEV_FUNCTION_TIMER;
+    const auto step = eng.CurrentStep();
+    auto ranksVar = io.InquireVariable<redev::LO>(ranksVarName);
+    auto geomVar = io.InquireVariable<redev::Real>(geomVarName);
+    auto cellsVar = io.InquireVariable<redev::LO>(cellsVarName);
+    auto dimVar = io.InquireVariable<redev::LO>(dimVarName);
+    assert(ranksVar && geomVar && cellsVar);
+    assert(dimVar);
+
+    auto blocksInfo = eng.BlocksInfo(ranksVar,step);
+    assert(blocksInfo.size()==1);
+    ranksVar.SetBlockSelection(blocksInfo[0].BlockID);
+    eng.Get(ranksVar, ranks);
+
+    redev::Reals geom;
+    auto geomBlocksInfo = eng.BlocksInfo(geomVar,step);
+    assert(geomBlocksInfo.size()==1);
+    geomVar.SetBlockSelection(geomBlocksInfo[0].BlockID);
+    eng.Get(geomVar, geom);
+
+    redev::LOs cellsIn;
+    auto cellsBlocksInfo = eng.BlocksInfo(cellsVar,step);
+    assert(cellsBlocksInfo.size()==1);
+    cellsVar.SetBlockSelection(cellsBlocksInfo[0].BlockID);
+    eng.Get(cellsVar, cellsIn);
+
+    eng.Get(dimVar, dim);
+    eng.PerformGets(); //default read mode is deferred
+
+    REDEV_ALWAYS_ASSERT(geom.size() == 6 && cellsIn.size() == 3);
+    for(int d=0; d<3; d++) {
+      origin[d] = geom[d];
+      spacing[d] = geom[3+d];
+      cells[d] = cellsIn[d];
+    }
+    Init();
+  }
+
+  void GridPtn::Broadcast(MPI_Comm comm, int root) {
+    REDEV_FUNCTION_TIMER;
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    redev::Broadcast(&dim, 1, root, comm);
+    redev::Broadcast(origin.data(), origin.size(), root, comm);
+    redev::Broadcast(spacing.data(), spacing.size(), root, comm);
+    redev::Broadcast(cells.data(), cells.size(), root, comm);
+    int count = ranks.size();
+    redev::Broadcast(&count, 1, root, comm);
+    if(root != rank) {
+      ranks.resize(count);
+    }
+    redev::Broadcast(ranks.data(), ranks.size(), root, comm);
+    Init();
+  }
+
+  SFCPtn::SFCPtn()
+    : dim(0), bits(0), boxMin{0,0,0}, boxMax{1,1,1}, scale{1,1,1} {
+    REDEV_FUNCTION_TIMER;
+  }
+
+  SFCPtn::SFCPtn(redev::LO dim_, const std::array<redev::Real,3>& boxMin_,
+      const std::array<redev::Real,3>& boxMax_, const Keys& splitters_,
+      const redev::LOs& ranks_)
+    : dim(dim_), boxMin(boxMin_), boxMax(boxMax_), splitters(splitters_), ranks(ranks_) {
+    REDEV_FUNCTION_TIMER;
+    REDEV_ALWAYS_ASSERT(dim>0 && dim<=3);
+    REDEV_ALWAYS_ASSERT(splitters.size() == ranks.size());
+    REDEV_ALWAYS_ASSERT(std::is_sorted(splitters.begin(), splitters.end()));
+    for(int d=0; d<dim; d++) {
+      REDEV_ALWAYS_ASSERT(boxMax[d] > boxMin[d]);
+    }
+    Init();
+  }
+
+  void SFCPtn::Init() {
+    //keep the interleaved key within 64 bits
+    bits = (dim == 3) ? 21 : 32;
+    const auto cellsPerAxis = std::ldexp(redev::Real(1), bits);
+    for(int d=0; d<3; d++) {
+      scale[d] = (d<dim) ? cellsPerAxis/(boxMax[d]-boxMin[d]) : 0;
+    }
+  }
+
+  SFCPtn::Keys SFCPtn::GetKeys(const redev::Reals& pts) const {
+    REDEV_FUNCTION_TIMER;
+    REDEV_ALWAYS_ASSERT(pts.size()%3 == 0);
+    const auto numPts = pts.size()/3;
+    Keys keys(numPts);
+    mortonKeys(dim, bits, pts.data(), numPts, boxMin, scale, keys.data());
+    return keys;
+  }
+
+  SFCPtn::Key SFCPtn::GetKey(const std::array<redev::Real,3>& pt) const {
+    REDEV_HOT_TIMER;
+    Key key;
+    mortonKeys(dim, bits, pt.data(), 1, boxMin, scale, &key);
+    return key;
+  }
+
+  std::size_t SFCPtn::FindSegment(Key key) const {
+    const auto s = splitters.data();
+    const auto len = splitters.size();
+    //short tables: count the splitters <= key; the loop vectorizes
+    const size_t linearSearchMax = 64;
+    if(len <= linearSearchMax) {
+      size_t count = 0;
+      for(size_t i=1; i<len; i++) {
+        count += (s[i] <= key);
+      }
+      return count;
+    }
+    //long tables: branch-free binary search for the last splitter <= key
+    size_t base = 0;
+    size_t n = len;
+    while(n > 1) {
+      const auto half = n/2;
+      base = (s[base+half] <= key) ? base+half : base;
+      n -= half;
+    }
+    return base;
+  }
+
+  redev::LO SFCPtn::GetRank(const std::array<redev::Real,3>& pt) const {
+    REDEV_HOT_TIMER;
+    assert(ranks.size());
+    return ranks[FindSegment(GetKey(pt))];
+  }
+
+  redev::LOs SFCPtn::GetRank(const redev::Reals& pts) const {
+    REDEV_FUNCTION_TIMER;
+    assert(ranks.size());
+    const auto keys = GetKeys(pts);
+    redev::LOs owners(keys.size());
+    if(keys.empty()) return owners;
+    if(std::is_sorted(keys.begin(), keys.end())) {
+      //walk the splitters once for the whole batch
+      auto seg = FindSegment(keys.front());
+      for(size_t n=0; n<keys.size(); n++) {
+        while(seg+1 < splitters.size() && splitters[seg+1] <= keys[n]) ++seg;
+        owners[n] = ranks[seg];
+      }
+    } else {
+      for(size_t n=0; n<keys.size(); n++) {
+        owners[n] = ranks[FindSegment(keys[n])];
+      }
+    }
+    return owners;
+  }
+
+  redev::LOs SFCPtn::GetRanks() const {
+    REDEV_FUNCTION_TIMER;
+    return ranks;
+  }
+
+  SFCPtn::Keys SFCPtn::GetSplitters() const {
+    REDEV_FUNCTION_TIMER;
+    return splitters;
+  }
+
+  std::array<redev::Real,3> SFCPtn::GetBoxMin() const {
+    REDEV_FUNCTION_TIMER;
+    return boxMin;
+  }
+
+  std::array<redev::Real,3> SFCPtn::GetBoxMax() const {
+    REDEV_FUNCTION_TIMER;
+    return boxMax;
+  }
+
+  void SFCPtn::Write(adios2::Engine& eng, adios2::IO& io) {
+    REDEV_FUNCTION_TIMER;
+    const auto len = ranks.size();
+    if(!len) return; //don't attempt zero length write
+    assert(len==splitters.size());
+    auto ranksVar = defineVariable<redev::LO>(io, ranksVarName,{},{},{len});
+    auto splittersVar = defineVariable<Key>(io, splittersVarName,{},{},{len});
+    auto boxVar = defineVariable<redev::Real>(io, boxVarName,{},{},{6});
+    auto dimVar = defineVariable<redev::LO>(io, dimVarName);
+    const redev::Reals box{boxMin[0],boxMin[1],boxMin[2],
+                           boxMax[0],boxMax[1],boxMax[2]};
+    eng.Put(ranksVar, ranks.data());
+    eng.Put(splittersVar, splitters.data());
+    eng.Put(boxVar, box.data());
+    eng.Put(dimVar, dim);
+    eng.PerformPuts();
+  }
+
+  void SFCPtn::Read(adios2::Engine& eng, adios2::IO& io) {
+    REDEV_FUNCTION_TIMER;
+    const auto step = eng.CurrentStep();
+    auto ranksVar = io.InquireVariable<redev::LO>(ranksVarName);
+    auto splittersVar = io.InquireVariable<Key>(splittersVarName);
+    auto boxVar = io.InquireVariable<redev::Real>(boxVarName);
+    auto dimVar = io.InquireVariable<redev::LO>(dimVarName);
+    assert(ranksVar && splittersVar && boxVar);
+    assert(dimVar);
+
+    auto blocksInfo = eng.BlocksInfo(ranksVar,step);
+    assert(blocksInfo.size()==1);
+    ranksVar.SetBlockSelection(blocksInfo[0].BlockID);
+    eng.Get(ranksVar, ranks);
+
+    auto splittersBlocksInfo = eng.BlocksInfo(splittersVar,step);
+    assert(splittersBlocksInfo.size()==1);
+    splittersVar.SetBlockSelection(splittersBlocksInfo[0].BlockID);
+    eng.Get(splittersVar, splitters);
+
+    redev::Reals box;
+    auto boxBlocksInfo = eng.BlocksInfo(boxVar,step);
+    assert(boxBlocksInfo.size()==1);
+    boxVar.SetBlockSelection(boxBlocksInfo[0].BlockID);
+    eng.Get(boxVar, box);
+
+    eng.Get(dimVar, dim);
+    eng.PerformGets(); //default read mode is deferred
+
+    REDEV_ALWAYS_ASSERT(box.size() == 6);
+    for(int d=0; d<3; d++) {
+      boxMin[d] = box[d];
+      boxMax[d] = box[3+d];
+    }
+    Init();
+  }
+
+  void SFCPtn::Broadcast(MPI_Comm comm, int root) {
     REDEV_FUNCTION_TIMER;
     int rank;
     MPI_Comm_rank(comm, &rank);
+    redev::Broadcast(&dim, 1, root, comm);
+    redev::Broadcast(boxMin.data(), boxMin.size(), root, comm);
+    redev::Broadcast(boxMax.data(), boxMax.size(), root, comm);
     int count = ranks.size();
     redev::Broadcast(&count, 1, root, comm);
     if(root != rank) {
       ranks.resize(count);
-      cuts.resize(count);
+      splitters.resize(count);
     }
     redev::Broadcast(ranks.data(), ranks.size(), root, comm);
-    redev::Broadcast(cuts.data(), cuts.size(), root, comm);
+    redev::Broadcast(splitters.data(), splitters.size(), root, comm);
+    Init();
   }
 
   // BP4 support
@@ -345,22 +1168,46 @@ namespace redev {
   Redev::Redev(MPI_Comm comm, Partition ptn, ProcessType processType, bool noClients)
     : comm(comm), adios(comm), ptn(ptn), processType(processType), noClients(noClients) {
     PERFSTUBS_INITIALIZE();
-    REDEV_FUNCTION_TIMER;
+    REDEV_PHASE_TIMER("redev::Redev");
     int isInitialized = 0;
     MPI_Initialized(&isInitialized);
     REDEV_ALWAYS_ASSERT(isInitialized);
     UpdateRank();
+    trace::InitializeFromEnvironment();
+    commmatrix::InitializeFromEnvironment();
   }
   Redev::Redev(MPI_Comm comm, ProcessType processType, bool noClients)
     : comm(comm), adios(comm), ptn(), processType(processType), noClients(noClients) {
       PERFSTUBS_INITIALIZE();
-      REDEV_FUNCTION_TIMER;
+      REDEV_PHASE_TIMER("redev::Redev");
       REDEV_ALWAYS_ASSERT(processType == ProcessType::Client);
       int isInitialized = 0;
       MPI_Initialized(&isInitialized);
       REDEV_ALWAYS_ASSERT(isInitialized);
       UpdateRank();
+      trace::InitializeFromEnvironment();
+      commmatrix::InitializeFromEnvironment();
     }
+  Redev::Redev(Redev&& other)
+    : processType(other.processType), noClients(other.noClients),
+      comm(other.comm), adios(std::move(other.adios)), rank(other.rank),
+      ptn(std::move(other.ptn)), partitionStorage(other.partitionStorage),
+      partitionVersion(other.partitionVersion), threadSafe(other.threadSafe),
+      finalized(std::exchange(other.finalized, true)) {
+  }
+  void Redev::Finalize() {
+    REDEV_FUNCTION_TIMER;
+    if(finalized)
+      return;
+    finalized = true;
+    trace::Flush(comm, processType == ProcessType::Server);
+    commmatrix::Write(adios, comm, processType == ProcessType::Server);
+    WriteTimerSummary(comm);
+  }
+  Redev::~Redev() {
+    if(!finalized)
+      Finalize();
+  }
 
   void AdiosChannel::Setup(adios2::IO& s2cIO, adios2::Engine& s2cEngine) {
     REDEV_FUNCTION_TIMER;
@@ -375,18 +1222,139 @@ namespace redev {
     CheckVersion(s2cEngine,s2cIO);
     auto status = s2cEngine.BeginStep();
     REDEV_ALWAYS_ASSERT(status == adios2::StepStatus::OK);
-    //rendezvous app rank 0 writes partition info and other apps read
-    if(!rank_) {
-      if(process_type_==ProcessType::Server) {
-        std::visit([&](auto&& partition){partition.Write(s2cEngine, s2cIO);}, partition_);
-      }
-      else {
-        std::visit([&](auto&& partition){partition.Read(s2cEngine, s2cIO);}, partition_);
+    //the partition version is sent so a client created after
+    //Redev::UpdatePartition starts with the version of the server
+    redev::GO version = partition_version_ ? *partition_version_ : 0;
+    if(process_type_==ProcessType::Server) {
+      auto versionVar = defineVariable<redev::GO>(s2cIO, partitionVersionVarName);
+      if(!rank_)
+        s2cEngine.Put(versionVar, version);
+      WritePartition(s2cEngine, s2cIO);
+    } else {
+      auto versionVar = s2cIO.InquireVariable<redev::GO>(partitionVersionVarName);
+      if(versionVar && !rank_) {
+        s2cEngine.Get(versionVar, version);
+        s2cEngine.PerformGets(); //default read mode is deferred
       }
+      ReadPartition(s2cEngine, s2cIO);
     }
     s2cEngine.EndStep();
-    std::visit([&](auto&& partition){partition.Broadcast(comm_);}, partition_);
+    BroadcastPartition();
+    if(process_type_==ProcessType::Client) {
+      redev::Broadcast(&version,1,0,comm_);
+      sent_partition_version_ = version;
+      if(partition_version_)
+        *partition_version_ = std::max(*partition_version_, version);
+    }
+  }
 
+  void AdiosChannel::WritePartition(adios2::Engine& eng, adios2::IO& io) {
+    REDEV_FUNCTION_TIMER;
+    //rendezvous app rank 0 writes partition info except for distributed
+    //partitions where all ranks write
+    std::visit([&](auto&& partition){
+      using PartitionT = std::decay_t<decltype(partition)>;
+      if constexpr (IsDistributedPartition<PartitionT>::value)
+        partition.Write(eng, io, comm_);
+      else if(!rank_)
+        partition.Write(eng, io);
+    }, partition_);
+  }
+
+  void AdiosChannel::ReadPartition(adios2::Engine& eng, adios2::IO& io) {
+    REDEV_FUNCTION_TIMER;
+    std::visit([&](auto&& partition){
+      using PartitionT = std::decay_t<decltype(partition)>;
+      if constexpr (IsDistributedPartition<PartitionT>::value)
+        partition.Read(eng, io, comm_);
+      else if constexpr (IsNodeShareablePartition<PartitionT>::value) {
+        //reading on rank 0 only would release the node shared arrays of the
+        //current partition there alone, their release is collective
+        if(partition_storage_ == PartitionStorage::NodeShared)
+          partition.ReadNodeShared(eng, io, comm_);
+        else if(!rank_)
+          partition.Read(eng, io);
+      }
+      else if(!rank_)
+        partition.Read(eng, io);
+    }, partition_);
+  }
+
+  void AdiosChannel::BroadcastPartition() {
+    REDEV_FUNCTION_TIMER;
+    std::visit([&](auto&& partition){
+      using PartitionT = std::decay_t<decltype(partition)>;
+      if constexpr (IsNodeShareablePartition<PartitionT>::value) {
+        if(partition_storage_ == PartitionStorage::NodeShared) {
+          //clients stored the partition while reading it, see ReadPartition
+          if(process_type_ == ProcessType::Server)
+            partition.BroadcastNodeShared(comm_);
+          return;
+        }
+      }
+      partition.Broadcast(comm_);
+    }, partition_);
+  }
+
+  void AdiosChannel::SendPartitionUpdate() {
+    REDEV_FUNCTION_TIMER;
+    if(!partition_version_ || *partition_version_ == sent_partition_version_)
+      return;
+    std::size_t partition_index = partition_.index();
+    auto typeVar = defineVariable<std::size_t>(s2c_io_, partitionTypeVarName);
+    auto versionVar = defineVariable<redev::GO>(s2c_io_, partitionVersionVarName);
+    if(!rank_) {
+      s2c_engine_.Put(typeVar, partition_index);
+      s2c_engine_.Put(versionVar, *partition_version_);
+    }
+    WritePartition(s2c_engine_, s2c_io_);
+    s2c_engine_.PerformPuts();
+    sent_partition_version_ = *partition_version_;
+  }
+
+  void AdiosChannel::ReceivePartitionUpdate() {
+    REDEV_FUNCTION_TIMER;
+    redev::GO version = -1;
+    std::size_t partition_index = partition_.index();
+    if(!rank_) {
+      auto versionVar = s2c_io_.InquireVariable<redev::GO>(partitionVersionVarName);
+      auto typeVar = s2c_io_.InquireVariable<std::size_t>(partitionTypeVarName);
+      if(versionVar && typeVar) {
+        s2c_engine_.Get(versionVar, version);
+        s2c_engine_.Get(typeVar, partition_index);
+        s2c_engine_.PerformGets(); //default read mode is deferred
+      }
+    }
+    redev::Broadcast(&version,1,0,comm_);
+    if(version <= sent_partition_version_)
+      return;
+    redev::Broadcast(&partition_index,1,0,comm_);
+    ConstructPartitionFromIndex(partition_index);
+    ReadPartition(s2c_engine_, s2c_io_);
+    BroadcastPartition();
+    sent_partition_version_ = version;
+    if(partition_version_)
+      *partition_version_ = std::max(*partition_version_, version);
+  }
+
+  adios2::StepStatus AdiosChannel::BeginReceiveStep(float timeoutSeconds) {
+    REDEV_FUNCTION_TIMER;
+    auto& engine = process_type_ == ProcessType::Client ? s2c_engine_ : c2s_engine_;
+    adios2::StepStatus status;
+    const auto start = std::chrono::steady_clock::now();
+    {
+      REDEV_TRACE_EVENT("BeginStep");
+      status = engine.BeginStep(adios2::StepMode::Read, timeoutSeconds);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    step_stats_.stepSeconds += elapsed.count();
+    if(status != adios2::StepStatus::OK)
+      return status;
+    step_stats_.stepLatency.Add(elapsed.count());
+    step_stats_.steps++;
+    if(process_type_ == ProcessType::Client)
+      ReceivePartitionUpdate();
+    return status;
   }
 
   /*
@@ -401,15 +1369,34 @@ namespace redev {
     auto status = c2sEngine.BeginStep();
     REDEV_ALWAYS_ASSERT(status == adios2::StepStatus::OK);
     redev::LO clientCommSz = 0;
+    //the reply of the clock offset exchange, only exchanged when tracing
+    const auto clockVarName = "redev client clock";
+    const bool traced = trace::Enabled();
+    std::array<std::int64_t,3> clock{};
     if(process_type_ == ProcessType::Client) {
       auto var = c2sIO.DefineVariable<redev::LO>(varName);
-      if(!rank_)
+      auto clockVar = traced ?
+        c2sIO.DefineVariable<std::int64_t>(clockVarName, {3}, {0}, {3}) :
+        adios2::Variable<std::int64_t>();
+      if(!rank_) {
         c2sEngine.Put(var, commSize);
+        if(clockVar) {
+          clock = {clock_sync_[0], clock_sync_[1], trace::WallNow()};
+          c2sEngine.Put(clockVar, clock.data(), adios2::Mode::Sync);
+        }
+      }
     } else {
       auto var = c2sIO.InquireVariable<redev::LO>(varName);
+      auto clockVar = traced ?
+        c2sIO.InquireVariable<std::int64_t>(clockVarName) :
+        adios2::Variable<std::int64_t>();
       if(var && !rank_) {
         c2sEngine.Get(var, clientCommSz);
+        if(clockVar)
+          c2sEngine.Get(clockVar, clock.data());
         c2sEngine.PerformGets(); //default read mode is deferred
+        if(clockVar)
+          trace::AddClockOffset(name_, clock[0], clock[1], clock[2], trace::WallNow());
       }
     }
     c2sEngine.EndStep();
@@ -430,15 +1417,32 @@ namespace redev {
     auto status = s2cEngine.BeginStep();
     REDEV_ALWAYS_ASSERT(status == adios2::StepStatus::OK);
     redev::LO serverCommSz = 0;
+    //the first message of the clock offset exchange, see trace::AddClockOffset,
+    //only exchanged when tracing
+    const auto clockVarName = "redev server clock";
+    const bool traced = trace::Enabled();
     if(process_type_==ProcessType::Server) {
       auto var = s2cIO.DefineVariable<redev::LO>(varName);
-      if(!rank_)
+      auto clockVar = traced ?
+        s2cIO.DefineVariable<std::int64_t>(clockVarName) :
+        adios2::Variable<std::int64_t>();
+      if(!rank_) {
         s2cEngine.Put(var, commSize);
+        if(clockVar)
+          s2cEngine.Put(clockVar, trace::WallNow(), adios2::Mode::Sync);
+      }
     } else {
       auto var = s2cIO.InquireVariable<redev::LO>(varName);
+      auto clockVar = traced ?
+        s2cIO.InquireVariable<std::int64_t>(clockVarName) :
+        adios2::Variable<std::int64_t>();
       if(var && !rank_) {
         s2cEngine.Get(var, serverCommSz);
+        if(clockVar)
+          s2cEngine.Get(clockVar, clock_sync_[0]);
         s2cEngine.PerformGets(); //default read mode is deferred
+        if(clockVar)
+          clock_sync_[1] = trace::WallNow();
       }
     }
     s2cEngine.EndStep();
@@ -450,7 +1454,7 @@ namespace redev {
   std::size_t
   AdiosChannel::SendPartitionTypeToClient(adios2::IO& s2cIO, adios2::Engine& s2cEngine) {
     REDEV_FUNCTION_TIMER;
-    const auto varName = "redev partition type";
+    const auto varName = partitionTypeVarName;
     auto status = s2cEngine.BeginStep();
     REDEV_ALWAYS_ASSERT(status == adios2::StepStatus::OK);
     std::size_t partition_index = partition_.index();
@@ -483,6 +1487,18 @@ void AdiosChannel::ConstructPartitionFromIndex(size_t partition_index) {
       partition_.emplace<RCBPtn>();
       REDEV_ALWAYS_ASSERT(partition_.index() == 1ULL);
       break;
+    case 2:
+      partition_.emplace<GridPtn>();
+      REDEV_ALWAYS_ASSERT(partition_.index() == 2ULL);
+      break;
+    case 3:
+      partition_.emplace<SFCPtn>();
+      REDEV_ALWAYS_ASSERT(partition_.index() == 3ULL);
+      break;
+    case 4:
+      partition_.emplace<DistributedClassPtn>();
+      REDEV_ALWAYS_ASSERT(partition_.index() == 4ULL);
+      break;
     default:
       Redev_Assert_Fail("Unhandled partition type");
     }
@@ -513,6 +1529,53 @@ void AdiosChannel::CheckVersion(adios2::Engine& eng, adios2::IO& io) {
   }
   ProcessType Redev::GetProcessType() const noexcept { return processType; }
   const Partition &Redev::GetPartition() const noexcept {return ptn;}
+  void Redev::SetPartitionStorage(PartitionStorage storage) noexcept {
+    partitionStorage = storage;
+  }
+  PartitionStorage Redev::GetPartitionStorage() const noexcept {
+    return partitionStorage;
+  }
+  Compression DefaultCompression(std::size_t minBytes) {
+    Compression compression;
+    compression.minBytes = minBytes;
+    // operators are attached per step with AddOperation since ADIOS2 2.8
+#if ADIOS2_VERSION_MAJOR * 100 + ADIOS2_VERSION_MINOR >= 208
+#if defined(ADIOS2_HAVE_BLOSC2) || defined(ADIOS2_HAVE_BLOSC)
+    compression.type = "blosc";
+    compression.params = {{"compressor", "zstd"}, {"clevel", "1"},
+                          {"doshuffle", "BLOSC_SHUFFLE"}};
+#elif defined(ADIOS2_HAVE_BZIP2)
+    compression.type = "bzip2";
+    compression.params = {{"blockSize100k", "1"}};
+#endif
+#endif
+    return compression;
+  }
+  void Redev::SetThreadSafe(bool threadSafe_) {
+    REDEV_FUNCTION_TIMER;
+    if(threadSafe_) {
+      int provided;
+      MPI_Query_thread(&provided);
+      REDEV_ALWAYS_ASSERT(provided == MPI_THREAD_MULTIPLE);
+    }
+    threadSafe = threadSafe_;
+  }
+  bool Redev::GetThreadSafe() const noexcept {
+    return threadSafe;
+  }
+  void Redev::UpdatePartition(Partition ptn_) {
+    REDEV_PHASE_TIMER("redev::Redev::UpdatePartition");
+    REDEV_ALWAYS_ASSERT(processType == ProcessType::Server);
+    //the partitions are not assignable, replace the alternative in place
+    std::visit([&](auto&& partition){
+      using PartitionT = std::decay_t<decltype(partition)>;
+      ptn.emplace<PartitionT>(std::move(partition));
+    }, ptn_);
+    ++partitionVersion;
+  }
+  redev::GO Redev::GetPartitionVersion() const noexcept {
+    return partitionVersion;
+  }
   bool Redev::RankParticipates() const noexcept { return comm != MPI_COMM_NULL; }
   void Redev::UpdateRank() {
     if(RankParticipates()) {
@@ -13,7 +13,9 @@
 #include "redev_bidirectional_comm.h"
 #include "redev_channel.h"
 #include "redev_partition.h"
+#include "redev_partition_builder.h"
 #include "redev_adios_channel.h"
+#include "redev_channel_set.h"
 
 namespace redev {
 
@@ -185,6 +187,24 @@ public:
    */
   Redev(MPI_Comm comm, ProcessType processType = ProcessType::Client,
         bool noClients = false);
+  /**
+   * Calls Finalize if it was not called. Collective on the communicator.
+   */
+  ~Redev();
+  Redev(const Redev &) = delete;
+  Redev &operator=(const Redev &) = delete;
+  /**
+   * The moved-from object no longer writes the outputs of Finalize.
+   */
+  Redev(Redev &&other);
+  Redev &operator=(Redev &&) = delete;
+  /**
+   * Write the trace, the communication matrix, and the timer summary of this
+   * application if they are enabled, see redev::trace, redev::commmatrix, and
+   * redev::EnableTimerSummary. Only the first call writes them. Collective on
+   * the communicator.
+   */
+  void Finalize();
   // FIXME UPDATE DOCS
   /**
    * Create a ADIOS2-based BidirectionalComm between the server and one client
@@ -204,12 +224,53 @@ public:
     if(RankParticipates()) {
       return AdiosChannel{
           adios,       comm, std::move(name), std::move(params), transportType,
-          processType, ptn,  std::move(path), noClients};
+          processType, ptn,  std::move(path), noClients, partitionStorage,
+          &partitionVersion, threadSafe};
     }
     return NoOpChannel{};
   }
   [[nodiscard]] ProcessType GetProcessType() const noexcept;
   [[nodiscard]] const Partition &GetPartition() const noexcept;
+  /**
+   * Set where the partition received during CreateAdiosChannel is kept.
+   * With PartitionStorage::NodeShared the RCBPtn and ClassPtn arrays are
+   * stored once per node in an MPI shared memory window instead of once per
+   * rank; other partitions are replicated. Must be called with the same value
+   * on all ranks before CreateAdiosChannel.
+   * @param[in] storage the storage of the partition
+   */
+  void SetPartitionStorage(PartitionStorage storage) noexcept;
+  [[nodiscard]] PartitionStorage GetPartitionStorage() const noexcept;
+  /**
+   * Allow several threads of a rank to call Send and Recv at the same time on
+   * different communicators of the channels created afterwards, within a
+   * communication phase begun and ended by one thread. Each communicator
+   * then uses its own duplicate of the MPI communicator passed to CreateComm
+   * and the calls into an ADIOS2 engine are serialized by a mutex per
+   * engine; the MPI collectives, packing, and statistics run concurrently.
+   * Requires MPI to be initialized with MPI_THREAD_MULTIPLE. Must be called
+   * with the same value on all ranks before CreateAdiosChannel.
+   * @param[in] threadSafe true to enable the thread-safe mode
+   */
+  void SetThreadSafe(bool threadSafe);
+  [[nodiscard]] bool GetThreadSafe() const noexcept;
+  /**
+   * Replace the partition on the server. The new partition is sent to the
+   * clients of each channel created by this Redev at the start of the
+   * channel's next send communication phase, without recreating the channel.
+   * Collective on the server communicator; like the constructor, each rank
+   * passes the same partition.
+   * @param[in] ptn the new partition
+   */
+  void UpdatePartition(Partition ptn);
+  /**
+   * Return the version of the partition. The partition sent while creating
+   * a channel is version zero and each call to UpdatePartition on the server
+   * increments it. Clients receive the new version with the new partition at
+   * the start of a receive communication phase, so a client can compare the
+   * version with the one its cached destinations were computed for.
+   */
+  [[nodiscard]] redev::GO GetPartitionVersion() const noexcept;
   [[nodiscard]] bool RankParticipates() const noexcept;
   [[nodiscard]] MPI_Comm GetMPIComm() const noexcept;
 private:
@@ -220,6 +281,11 @@ private:
   adios2::ADIOS adios;
   int rank;
   Partition ptn;
+  PartitionStorage partitionStorage = PartitionStorage::Replicated;
+  redev::GO partitionVersion = 0;
+  bool threadSafe = false;
+  // true once Finalize ran or the object was moved from
+  bool finalized = false;
 };
 
 } // namespace redev
@@ -2,7 +2,11 @@
 #define REDEV_REDEV_ADIOS_CHANNEL_H
 #include "redev_assert.h"
 #include "redev_profile.h"
+#include "redev_trace.h"
 #include <adios2.h>
+#include <array>
+#include <memory>
+#include <mutex>
 
 namespace redev {
 
@@ -11,11 +15,20 @@ public:
   AdiosChannel(adios2::ADIOS &adios, MPI_Comm comm, std::string name,
                adios2::Params params, TransportType transportType,
                ProcessType processType, Partition &partition, std::string path,
-               bool noClients = false)
-      : comm_(comm), process_type_(processType), partition_(partition)
+               bool noClients = false,
+               PartitionStorage partitionStorage = PartitionStorage::Replicated,
+               redev::GO *partitionVersion = nullptr, bool threadSafe = false)
+      : name_(name), comm_(comm), process_type_(processType),
+        partition_(partition),
+        partition_storage_(partitionStorage),
+        partition_version_(partitionVersion),
+        sent_partition_version_(partitionVersion ? *partitionVersion : 0),
+        s2c_mutex_(threadSafe ? std::make_shared<std::mutex>() : nullptr),
+        c2s_mutex_(threadSafe ? std::make_shared<std::mutex>() : nullptr)
 
   {
-    REDEV_FUNCTION_TIMER;
+    REDEV_PHASE_TIMER("redev::AdiosChannel setup");
+    REDEV_TRACE_EVENT("AdiosChannel setup");
     MPI_Comm_rank(comm, &rank_);
     auto s2cName = path + name + "_s2c";
     auto c2sName = path + name + "_c2s";
@@ -72,10 +85,18 @@ public:
         c2s_engine_(std::exchange(o.c2s_engine_, adios2::Engine())),
         s2c_engine_(std::exchange(o.s2c_engine_, adios2::Engine())),
         num_client_ranks_(o.num_client_ranks_),
-        num_server_ranks_(o.num_server_ranks_),
+        num_server_ranks_(o.num_server_ranks_), name_(std::move(o.name_)),
         comm_(std::exchange(o.comm_, MPI_COMM_NULL)),
         process_type_(o.process_type_), rank_(o.rank_),
-        partition_(o.partition_) {REDEV_FUNCTION_TIMER;}
+        partition_(o.partition_), partition_storage_(o.partition_storage_),
+        partition_version_(o.partition_version_),
+        sent_partition_version_(o.sent_partition_version_),
+        step_stats_(std::move(o.step_stats_)),
+        comm_stats_(std::move(o.comm_stats_)), clock_sync_(o.clock_sync_),
+        s2c_mutex_(std::move(o.s2c_mutex_)),
+        c2s_mutex_(std::move(o.c2s_mutex_)) {
+    REDEV_FUNCTION_TIMER;
+  }
   AdiosChannel operator=(AdiosChannel &&) = delete;
   // FIXME IMPL RULE OF 5
   ~AdiosChannel() {
@@ -90,15 +111,21 @@ public:
     }
   }
   template <typename T>
-  [[nodiscard]] BidirectionalComm<T> CreateComm(std::string name, MPI_Comm comm) {
+  [[nodiscard]] BidirectionalComm<T>
+  CreateComm(std::string name, MPI_Comm comm,
+             const Compression &compression = {}) {
     REDEV_FUNCTION_TIMER;
     // TODO, remove s2c/c2s destinction on variable names then use std::move
     // name
     if(comm != MPI_COMM_NULL) {
       auto s2c = std::make_unique<AdiosComm<T>>(comm, num_client_ranks_,
-                                                s2c_engine_, s2c_io_, name);
+                                                s2c_engine_, s2c_io_, name,
+                                                s2c_mutex_, compression);
       auto c2s = std::make_unique<AdiosComm<T>>(comm, num_server_ranks_,
-                                                c2s_engine_, c2s_io_, name);
+                                                c2s_engine_, c2s_io_, name,
+                                                c2s_mutex_, compression);
+      comm_stats_.push_back(s2c->GetSharedStats());
+      comm_stats_.push_back(c2s->GetSharedStats());
       switch (process_type_) {
       case ProcessType::Client:
         return {std::move(c2s), std::move(s2c)};
@@ -114,17 +141,27 @@ public:
   void BeginSendCommunicationPhase() {
     REDEV_FUNCTION_TIMER;
     adios2::StepStatus status;
-    switch (process_type_) {
-    case ProcessType::Client:
-      status = c2s_engine_.BeginStep();
-      break;
-    case ProcessType::Server:
-      status = s2c_engine_.BeginStep();
-      break;
+    {
+      REDEV_TRACE_EVENT("BeginStep");
+      StatsTimer stepTimer(step_stats_.stepSeconds, &step_stats_.stepLatency);
+      switch (process_type_) {
+      case ProcessType::Client:
+        status = c2s_engine_.BeginStep();
+        break;
+      case ProcessType::Server:
+        status = s2c_engine_.BeginStep();
+        break;
+      }
     }
+    step_stats_.steps++;
     REDEV_ALWAYS_ASSERT(status == adios2::StepStatus::OK);
+    if (process_type_ == ProcessType::Server) {
+      SendPartitionUpdate();
+    }
   }
   void EndSendCommunicationPhase() {
+    REDEV_TRACE_EVENT("EndStep");
+    StatsTimer stepTimer(step_stats_.stepSeconds);
     switch (process_type_) {
     case ProcessType::Client:
       c2s_engine_.EndStep();
@@ -136,19 +173,27 @@ public:
   }
   void BeginReceiveCommunicationPhase() {
     REDEV_FUNCTION_TIMER;
-    adios2::StepStatus status;
-    switch (process_type_) {
-    case ProcessType::Client:
-      status = s2c_engine_.BeginStep();
-      break;
-    case ProcessType::Server:
-      status = c2s_engine_.BeginStep();
-      break;
-    }
+    const auto status = BeginReceiveStep(-1.0f);
     REDEV_ALWAYS_ASSERT(status == adios2::StepStatus::OK);
   }
+  /**
+   * Begin the receive communication phase if the other application has
+   * ended its send phase within timeoutSeconds, a negative timeout waits
+   * forever. Return false, without beginning the phase, if the step is not
+   * ready. This is collective over the channel's communicator; the engine
+   * decides readiness on one rank and all ranks get the same result.
+   */
+  [[nodiscard]] bool TryBeginReceiveCommunicationPhase(float timeoutSeconds) {
+    REDEV_FUNCTION_TIMER;
+    const auto status = BeginReceiveStep(timeoutSeconds);
+    REDEV_ALWAYS_ASSERT(status == adios2::StepStatus::OK ||
+                        status == adios2::StepStatus::NotReady);
+    return status == adios2::StepStatus::OK;
+  }
   void EndReceiveCommunicationPhase() {
     REDEV_FUNCTION_TIMER;
+    REDEV_TRACE_EVENT("EndStep");
+    StatsTimer stepTimer(step_stats_.stepSeconds);
     switch (process_type_) {
     case ProcessType::Client:
       s2c_engine_.EndStep();
@@ -158,6 +203,23 @@ public:
       break;
     }
   }
+  /**
+   * Return the statistics of the steps on this channel and of the sends and
+   * receives of all communicators created from it.
+   */
+  [[nodiscard]] CommStats GetStats() const {
+    auto stats = step_stats_;
+    for (const auto &commStats : comm_stats_) {
+      stats.Merge(*commStats);
+    }
+    return stats;
+  }
+  void ResetStats() {
+    step_stats_.Reset();
+    for (const auto &commStats : comm_stats_) {
+      commStats->Reset();
+    }
+  }
 
 private:
   void openEnginesBP4(bool noClients, std::string s2cName, std::string c2sName,
@@ -175,6 +237,25 @@ private:
   void Setup(adios2::IO &s2cIO, adios2::Engine &s2cEngine);
   void CheckVersion(adios2::Engine &eng, adios2::IO &io);
   void ConstructPartitionFromIndex(size_t partition_index);
+  void WritePartition(adios2::Engine &eng, adios2::IO &io);
+  void ReadPartition(adios2::Engine &eng, adios2::IO &io);
+  void BroadcastPartition();
+  /**
+   * Begin a step of the engine this process reads from and, if it is ready,
+   * read the partition update. Only the steps that are ready are counted and
+   * added to the step latency histogram.
+   */
+  adios2::StepStatus BeginReceiveStep(float timeoutSeconds);
+  /**
+   * On the server, write the partition in the current step if it changed
+   * since it was last sent.
+   */
+  void SendPartitionUpdate();
+  /**
+   * On the client, read the partition if the server wrote a newer version of
+   * it in the current step.
+   */
+  void ReceivePartitionUpdate();
 
   adios2::IO s2c_io_;
   adios2::IO c2s_io_;
@@ -182,10 +263,25 @@ private:
   adios2::Engine c2s_engine_;
   redev::LO num_client_ranks_;
   redev::LO num_server_ranks_;
+  std::string name_;
   MPI_Comm comm_;
   ProcessType process_type_;
   int rank_;
   Partition &partition_;
+  PartitionStorage partition_storage_;
+  // version of partition_ owned by Redev, nullptr if it is never updated
+  redev::GO *partition_version_;
+  // version most recently sent (server) or received (client) on this channel
+  redev::GO sent_partition_version_;
+  CommStats step_stats_;
+  std::vector<std::shared_ptr<CommStats>> comm_stats_;
+  // client wall clock times the server clock was sent and received during
+  // setup, see trace::AddClockOffset
+  std::array<std::int64_t, 2> clock_sync_{};
+  // serialize the calls of the communicators into each engine in the
+  // thread-safe mode, see Redev::SetThreadSafe; nullptr otherwise
+  std::shared_ptr<std::mutex> s2c_mutex_;
+  std::shared_ptr<std::mutex> c2s_mutex_;
 };
 } // namespace redev
 
@@ -42,6 +42,20 @@ public:
     REDEV_ALWAYS_ASSERT(receiver != nullptr);
     return receiver->Recv(mode);
   }
+  /**
+   * Return the statistics of the sends and receives on this rank.
+   */
+  [[nodiscard]] CommStats GetStats() const {
+    REDEV_ALWAYS_ASSERT(sender != nullptr && receiver != nullptr);
+    auto stats = sender->GetStats();
+    stats.Merge(receiver->GetStats());
+    return stats;
+  }
+  void ResetStats() {
+    REDEV_ALWAYS_ASSERT(sender != nullptr && receiver != nullptr);
+    sender->ResetStats();
+    receiver->ResetStats();
+  }
 
 private:
   std::unique_ptr<Communicator<T>> sender;
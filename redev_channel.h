@@ -1,6 +1,7 @@
 #ifndef REDEV_REDEV_CHANNEL_H
 #define REDEV_REDEV_CHANNEL_H
 #include "redev_bidirectional_comm.h"
+#include <atomic>
 #include <variant>
 
 namespace redev {
@@ -15,27 +16,55 @@ public:
         receive_communication_phase_active_(false) {
         REDEV_FUNCTION_TIMER;
         }
+  // the phase flags are atomic so they may be queried from the threads
+  // sending and receiving in the thread-safe mode, see Redev::SetThreadSafe
+  Channel(Channel &&other) noexcept
+      : pimpl_(std::move(other.pimpl_)),
+        send_communication_phase_active_(
+            other.send_communication_phase_active_.load()),
+        receive_communication_phase_active_(
+            other.receive_communication_phase_active_.load()),
+        send_phase_begin_(other.send_phase_begin_),
+        receive_phase_begin_(other.receive_phase_begin_) {}
+  Channel &operator=(Channel &&other) noexcept {
+    pimpl_ = std::move(other.pimpl_);
+    send_communication_phase_active_.store(
+        other.send_communication_phase_active_.load());
+    receive_communication_phase_active_.store(
+        other.receive_communication_phase_active_.load());
+    send_phase_begin_ = other.send_phase_begin_;
+    receive_phase_begin_ = other.receive_phase_begin_;
+    return *this;
+  }
 
   // For cases where we may be interested in storing the comm variant rather
   // than the exact type this function can be used to reduce the runtime
   // overhead of converting from the variant to the explicit type back to the
   // variant
-  template <typename T> [[nodiscard]] CommV CreateCommV(std::string name, MPI_Comm comm) {
+  template <typename T>
+  [[nodiscard]] CommV CreateCommV(std::string name, MPI_Comm comm,
+                                  const Compression &compression = {}) {
     REDEV_FUNCTION_TIMER;
     return pimpl_->CreateComm(std::move(name), comm,
-                              InvCommunicatorTypeMap<T>::value);
+                              InvCommunicatorTypeMap<T>::value, compression);
   }
   // convenience typesafe wrapper to get back the specific communicator type
   // rather than the variant. This is here to simplify updating legacy code
   // that expects a typed communicator to be created.
+  // The messages this application sends with the communicator are compressed
+  // as set by compression, see redev::Compression; by default they are not.
   template <typename T>
-  [[nodiscard]] BidirectionalComm<T> CreateComm(std::string name, MPI_Comm comm) {
+  [[nodiscard]] BidirectionalComm<T>
+  CreateComm(std::string name, MPI_Comm comm,
+             const Compression &compression = {}) {
     REDEV_FUNCTION_TIMER;
-    return std::get<BidirectionalComm<T>>(CreateCommV<T>(std::move(name), comm));
+    return std::get<BidirectionalComm<T>>(
+        CreateCommV<T>(std::move(name), comm, compression));
   }
   void BeginSendCommunicationPhase() {
     REDEV_FUNCTION_TIMER;
     REDEV_ALWAYS_ASSERT(InSendCommunicationPhase() == false);
+    send_phase_begin_ = trace::Enabled() ? trace::Now() : -1;
     pimpl_->BeginSendCommunicationPhase();
     send_communication_phase_active_ = true;
   }
@@ -44,27 +73,62 @@ public:
     REDEV_ALWAYS_ASSERT(InSendCommunicationPhase() == true);
     pimpl_->EndSendCommunicationPhase();
     send_communication_phase_active_ = false;
+    if (send_phase_begin_ >= 0)
+      trace::Record("send phase", send_phase_begin_, trace::Now());
   }
   void BeginReceiveCommunicationPhase() {
     REDEV_FUNCTION_TIMER;
     REDEV_ALWAYS_ASSERT(InReceiveCommunicationPhase() == false);
+    receive_phase_begin_ = trace::Enabled() ? trace::Now() : -1;
     pimpl_->BeginReceiveCommunicationPhase();
     receive_communication_phase_active_ = true;
   }
+  /**
+   * Begin the receive communication phase if the other application ends its
+   * send phase within timeoutSeconds, a negative timeout waits forever.
+   * Return true if the phase began, otherwise the channel is unchanged and
+   * the call may be repeated. Collective over the channel's communicator.
+   * See ChannelSet::WaitAny to wait for the first of several channels.
+   */
+  [[nodiscard]] bool TryBeginReceiveCommunicationPhase(float timeoutSeconds) {
+    REDEV_FUNCTION_TIMER;
+    REDEV_ALWAYS_ASSERT(InReceiveCommunicationPhase() == false);
+    const auto begin = trace::Enabled() ? trace::Now() : -1;
+    if (!pimpl_->TryBeginReceiveCommunicationPhase(timeoutSeconds))
+      return false;
+    receive_phase_begin_ = begin;
+    receive_communication_phase_active_ = true;
+    return true;
+  }
   void EndReceiveCommunicationPhase() {
     REDEV_FUNCTION_TIMER;
     REDEV_ALWAYS_ASSERT(InReceiveCommunicationPhase() == true);
     pimpl_->EndReceiveCommunicationPhase();
     receive_communication_phase_active_ = false;
+    if (receive_phase_begin_ >= 0)
+      trace::Record("receive phase", receive_phase_begin_, trace::Now());
   }
   [[nodiscard]] bool InSendCommunicationPhase() const noexcept {
-    REDEV_FUNCTION_TIMER;
+    REDEV_HOT_TIMER;
     return send_communication_phase_active_;
   }
   [[nodiscard]] bool InReceiveCommunicationPhase() const noexcept {
-    REDEV_FUNCTION_TIMER;
+    REDEV_HOT_TIMER;
     return receive_communication_phase_active_;
   }
+  /**
+   * Return the statistics of the steps on this channel and of the sends and
+   * receives of all communicators created from it on this rank. Pass the
+   * result to redev::Report to summarize it across ranks.
+   */
+  [[nodiscard]] CommStats GetStats() const {
+    REDEV_FUNCTION_TIMER;
+    return pimpl_->GetStats();
+  }
+  void ResetStats() {
+    REDEV_FUNCTION_TIMER;
+    pimpl_->ResetStats();
+  }
 
   template <typename Func, typename... Args>
   auto SendPhase(const Func &f, Args &&...args) {
@@ -80,11 +144,15 @@ public:
 private:
   class ChannelConcept {
   public:
-    virtual CommV CreateComm(std::string &&, MPI_Comm, CommunicatorDataType) = 0;
+    virtual CommV CreateComm(std::string &&, MPI_Comm, CommunicatorDataType,
+                             const Compression &) = 0;
     virtual void BeginSendCommunicationPhase() = 0;
     virtual void EndSendCommunicationPhase() = 0;
     virtual void BeginReceiveCommunicationPhase() = 0;
+    virtual bool TryBeginReceiveCommunicationPhase(float) = 0;
     virtual void EndReceiveCommunicationPhase() = 0;
+    [[nodiscard]] virtual CommStats GetStats() const = 0;
+    virtual void ResetStats() = 0;
     virtual ~ChannelConcept() noexcept {}
   };
   template <typename T> class ChannelModel final : public ChannelConcept {
@@ -97,61 +165,62 @@ private:
     // beautiful construction in the world.
     ~ChannelModel() noexcept final {}
     [[nodiscard]] CommV CreateComm(std::string &&name, MPI_Comm comm,
-                                   CommunicatorDataType type) final {
+                                   CommunicatorDataType type,
+                                   const Compression &compression) final {
       REDEV_FUNCTION_TIMER;
       switch (type) {
       case CommunicatorDataType::INT8:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::INT8>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::INT16:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::INT16>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::INT32:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::INT32>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::INT64:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::INT64>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::UINT8:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::UINT8>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::UINT16:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::UINT16>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::UINT32:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::UINT32>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::UINT64:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::UINT64>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::LONG_INT:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::LONG_INT>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::FLOAT:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::FLOAT>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::DOUBLE:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::DOUBLE>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::LONG_DOUBLE:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::LONG_DOUBLE>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       case CommunicatorDataType::COMPLEX_DOUBLE:
         return CommV{impl_.template CreateComm<
             CommunicatorTypeMap<CommunicatorDataType::COMPLEX_DOUBLE>::type>(
-            std::move(name), comm)};
+            std::move(name), comm, compression)};
       }
       return {};
     }
@@ -167,10 +236,22 @@ private:
       REDEV_FUNCTION_TIMER;
       impl_.BeginReceiveCommunicationPhase();
     }
+    bool TryBeginReceiveCommunicationPhase(float timeoutSeconds) final {
+      REDEV_FUNCTION_TIMER;
+      return impl_.TryBeginReceiveCommunicationPhase(timeoutSeconds);
+    }
     void EndReceiveCommunicationPhase() final {
       REDEV_FUNCTION_TIMER;
       impl_.EndReceiveCommunicationPhase();
     }
+    [[nodiscard]] CommStats GetStats() const final {
+      REDEV_FUNCTION_TIMER;
+      return impl_.GetStats();
+    }
+    void ResetStats() final {
+      REDEV_FUNCTION_TIMER;
+      impl_.ResetStats();
+    }
 
   private:
     T impl_;
@@ -197,21 +278,29 @@ private:
   };
 
   std::unique_ptr<ChannelConcept> pimpl_;
-  bool send_communication_phase_active_;
-  bool receive_communication_phase_active_;
+  std::atomic<bool> send_communication_phase_active_;
+  std::atomic<bool> receive_communication_phase_active_;
+  // start times of the current send and receive phases for tracing, they may
+  // overlap in the thread-safe mode; -1 if tracing is disabled
+  std::int64_t send_phase_begin_ = -1;
+  std::int64_t receive_phase_begin_ = -1;
 };
 
 class NoOpChannel {
 public:
   template <typename T>
   [[nodiscard]]
-  BidirectionalComm<T> CreateComm(std::string, MPI_Comm) {
+  BidirectionalComm<T> CreateComm(std::string, MPI_Comm,
+                                  const Compression & = {}) {
     return {std::make_unique<NoOpComm<T>>(), std::make_unique<NoOpComm<T>>()};
   }
   void BeginSendCommunicationPhase(){}
   void EndSendCommunicationPhase(){}
   void BeginReceiveCommunicationPhase(){}
+  [[nodiscard]] bool TryBeginReceiveCommunicationPhase(float) { return true; }
   void EndReceiveCommunicationPhase(){}
+  [[nodiscard]] CommStats GetStats() const { return {}; }
+  void ResetStats(){}
 };
 
 } // namespace redev
@@ -0,0 +1,77 @@
+#include "redev.h"
+#include "redev_channel_set.h"
+#include "redev_assert.h"
+#include "redev_comm.h"
+#include "redev_profile.h"
+#include <algorithm> //sort
+#include <chrono>
+#include <numeric> //iota
+#include <thread>  //std::this_thread::sleep_for
+
+namespace redev {
+
+ChannelSet::ChannelSet(MPI_Comm comm, double pollSeconds)
+    : comm_(comm), poll_seconds_(pollSeconds) {
+  REDEV_FUNCTION_TIMER;
+  REDEV_ALWAYS_ASSERT(comm != MPI_COMM_NULL);
+  REDEV_ALWAYS_ASSERT(pollSeconds >= 0);
+}
+
+std::size_t ChannelSet::Add(Channel &channel) {
+  REDEV_FUNCTION_TIMER;
+  channels_.push_back(&channel);
+  return channels_.size() - 1;
+}
+
+std::optional<std::size_t> ChannelSet::WaitAny(float timeoutSeconds) {
+  REDEV_FUNCTION_TIMER;
+  std::vector<std::size_t> all(channels_.size());
+  std::iota(all.begin(), all.end(), 0);
+  return WaitAny(all, timeoutSeconds);
+}
+
+std::optional<std::size_t>
+ChannelSet::WaitAny(const std::vector<std::size_t> &candidates,
+                    float timeoutSeconds) {
+  REDEV_FUNCTION_TIMER;
+  const auto numChannels = channels_.size();
+  // poll in round robin order starting at next_
+  std::vector<std::size_t> order;
+  for (const auto i : candidates) {
+    REDEV_ALWAYS_ASSERT(i < numChannels);
+    if (!channels_[i]->InReceiveCommunicationPhase())
+      order.push_back(i);
+  }
+  REDEV_ALWAYS_ASSERT(!order.empty());
+  std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return (a + numChannels - next_) % numChannels <
+           (b + numChannels - next_) % numChannels;
+  });
+  int rank;
+  MPI_Comm_rank(comm_, &rank);
+  const auto start = std::chrono::steady_clock::now();
+  while (true) {
+    for (const auto i : order) {
+      // the engines agree on the status across ranks so all ranks return the
+      // same channel
+      if (channels_[i]->TryBeginReceiveCommunicationPhase(0.0f)) {
+        next_ = (i + 1) % numChannels;
+        return i;
+      }
+    }
+    // rank 0 decides the timeout so all ranks stop after the same pass
+    bool expired = false;
+    if (timeoutSeconds >= 0 && !rank) {
+      const std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+      expired = elapsed.count() >= timeoutSeconds;
+    }
+    if (timeoutSeconds >= 0)
+      redev::Broadcast(&expired, 1, 0, comm_);
+    if (expired)
+      return std::nullopt;
+    std::this_thread::sleep_for(std::chrono::duration<double>(poll_seconds_));
+  }
+}
+
+} // namespace redev
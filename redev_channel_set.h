@@ -0,0 +1,74 @@
+#ifndef REDEV_REDEV_CHANNEL_SET_H
+#define REDEV_REDEV_CHANNEL_SET_H
+#include "redev_channel.h"
+#include <mpi.h>
+#include <optional>
+#include <vector>
+
+namespace redev {
+
+/**
+ * A set of channels, typically one per client of a server, whose receive
+ * phases are begun in the order the other applications become ready rather
+ * than in a fixed order, so one slow client does not delay the service of the
+ * others. The set stores references; the channels must outlive it.
+ *
+ * A server that receives from each client once per round:
+ * \code
+ * redev::ChannelSet set(rdv.GetMPIComm());
+ * for(auto& channel : channels) set.Add(channel);
+ * std::vector<std::size_t> pending{0, 1, 2};
+ * while(!pending.empty()) {
+ *   const auto i = *set.WaitAny(pending);
+ *   auto msgs = comms[i].Recv();
+ *   channels[i].EndReceiveCommunicationPhase();
+ *   pending.erase(std::find(pending.begin(), pending.end(), i));
+ * }
+ * \endcode
+ */
+class ChannelSet {
+public:
+  /**
+   * @param[in] comm the ranks of the application, all of them call WaitAny
+   * @param[in] pollSeconds the time to sleep after a pass over the channels
+   * found none ready
+   */
+  explicit ChannelSet(MPI_Comm comm, double pollSeconds = 1e-3);
+  /**
+   * Add a channel to the set.
+   * @return the index of the channel in the set
+   */
+  std::size_t Add(Channel &channel);
+  [[nodiscard]] std::size_t Size() const noexcept { return channels_.size(); }
+  [[nodiscard]] Channel &operator[](std::size_t i) { return *channels_[i]; }
+  /**
+   * Poll the channels with Channel::TryBeginReceiveCommunicationPhase until
+   * one of them begins its receive phase, and return its index. The caller
+   * must end the phase. Channels already in a receive phase are skipped. The
+   * polling starts after the channel returned by the previous call, so a
+   * client that is always ready does not starve the others. Collective over
+   * the communicator passed to the constructor.
+   * @param[in] timeoutSeconds give up after this time, measured on rank 0;
+   * negative waits forever
+   * @return the index of the ready channel, or std::nullopt on timeout
+   */
+  [[nodiscard]] std::optional<std::size_t> WaitAny(float timeoutSeconds = -1.0f);
+  /**
+   * WaitAny over a subset of the channels.
+   * @param[in] candidates the indices of the channels to poll
+   * @param[in] timeoutSeconds see WaitAny(float)
+   */
+  [[nodiscard]] std::optional<std::size_t>
+  WaitAny(const std::vector<std::size_t> &candidates,
+          float timeoutSeconds = -1.0f);
+
+private:
+  MPI_Comm comm_;
+  double poll_seconds_;
+  std::vector<Channel *> channels_;
+  // index of the channel after the one most recently returned by WaitAny
+  std::size_t next_ = 0;
+};
+
+} // namespace redev
+#endif // REDEV_REDEV_CHANNEL_SET_H
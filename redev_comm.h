@@ -9,6 +9,12 @@
 #include <type_traits> // is_same
 #include <adios2.h>
 #include "redev_time.h"
+#include "redev_stats.h"
+#include "redev_trace.h"
+#include "redev_comm_matrix.h"
+#include <memory>
+#include <mutex>
+#include <string>
 
 namespace {
 void checkStep(adios2::StepStatus status) {
@@ -27,6 +33,39 @@ enum class Mode {
   Synchronous
 };
 
+/**
+ * Compression of the messages sent by a communicator with an ADIOS2
+ * operator, see Channel::CreateComm. The operator is attached to the message
+ * variable only, the offsets and source ranks metadata are not compressed.
+ * Reading decompresses transparently. Requires ADIOS2 2.8 or newer.
+ */
+struct Compression {
+  /**
+   * ADIOS2 operator type, e.g., "blosc" or "bzip2", that the ADIOS2 build
+   * provides; empty disables compression. Lossy operators, e.g., "zfp", are
+   * accepted but change the received values.
+   */
+  std::string type;
+  /// operator parameters, e.g., {{"compressor","zstd"},{"clevel","3"}} for blosc
+  adios2::Params params;
+  /**
+   * Send without compression when the message bytes averaged over the
+   * sending ranks are below this; small blocks compress poorly and the
+   * operator overhead dominates. The choice is made at the first Send since
+   * the message layout of a communicator is fixed afterwards.
+   * util_benchsrSweep --compressions measures the break-even size.
+   */
+  std::size_t minBytes = 64 * 1024;
+};
+
+/**
+ * Return the lossless compression available in the ADIOS2 build: blosc with
+ * zstd, otherwise bzip2, otherwise, or before ADIOS2 2.8, an empty type,
+ * i.e., no compression.
+ * @param[in] minBytes see Compression::minBytes
+ */
+[[nodiscard]] Compression DefaultCompression(std::size_t minBytes = 64 * 1024);
+
 template<class T>
 [[ nodiscard ]]
 constexpr MPI_Datatype getMpiType(T) noexcept {
@@ -138,6 +177,14 @@ class Communicator {
     virtual std::vector<T> Recv(Mode mode) = 0;
 
     virtual InMessageLayout GetInMessageLayout() = 0;
+    /**
+     * Return the communication statistics recorded on this rank.
+     */
+    virtual CommStats GetStats() const { return {}; }
+    /**
+     * Zero the communication statistics recorded on this rank.
+     */
+    virtual void ResetStats() {}
     virtual ~Communicator() = default;
 };
 
@@ -173,10 +220,28 @@ class AdiosComm : public Communicator<T> {
      * @param[in] eng_ ADIOS2 engine for writing on the sender side
      * @param[in] io_ ADIOS2 IO associated with eng_
      * @param[in] name_ unique name among AdiosComm objects
+     * @param[in] engMutex_ if not null, the thread-safe mode: calls into eng_
+     *            are serialized by this mutex, shared by all AdiosComm objects
+     *            using eng_, and comm_ is duplicated so Send/Recv on different
+     *            objects can run in different threads
+     * @param[in] compression_ compression of the messages sent
      */
-    AdiosComm(MPI_Comm comm_, int recvRanks_, adios2::Engine& eng_, adios2::IO& io_, std::string name_)
-      : comm(comm_), recvRanks(recvRanks_), eng(eng_), io(io_), name(name_), verbose(0) {
+    AdiosComm(MPI_Comm comm_, int recvRanks_, adios2::Engine& eng_, adios2::IO& io_, std::string name_,
+        std::shared_ptr<std::mutex> engMutex_ = nullptr, Compression compression_ = {})
+      : comm(comm_), recvRanks(recvRanks_), eng(eng_), io(io_), name(name_), verbose(0),
+        engMutex(std::move(engMutex_)), compression(std::move(compression_)) {
         inMsg.knownSizes = false;
+#if ADIOS2_VERSION_MAJOR * 100 + ADIOS2_VERSION_MINOR < 208
+        REDEV_ALWAYS_ASSERT(compression.type.empty()); //needs ADIOS2 2.8
+#endif
+        if(engMutex)
+          MPI_Comm_dup(comm_, &comm);
+    }
+    ~AdiosComm() {
+      int finalized = 0;
+      MPI_Finalized(&finalized);
+      if(engMutex && !finalized)
+        MPI_Comm_free(&comm);
     }
     
     /// We are explicitly not allowing copy/move constructor/assignment as we don't
@@ -192,6 +257,9 @@ class AdiosComm : public Communicator<T> {
     }
     void Send(T *msgs, Mode mode) {
       REDEV_FUNCTION_TIMER;
+      //the time is split into metadataSeconds and transferSeconds below
+      StatsTimer sendTimer(stats->sendLatency);
+      auto t1 = redev::getTime();
       int rank, commSz;
       MPI_Comm_rank(comm, &rank);
       MPI_Comm_size(comm, &commSz);
@@ -201,6 +269,24 @@ class AdiosComm : public Communicator<T> {
         assert(destRank < recvRanks);
         degree[destRank] += outMsg.offsets[i+1] - outMsg.offsets[i];
       }
+      stats->sends++;
+      stats->bytesSentPerDest.resize(recvRanks, 0);
+      for( int i=0; i<recvRanks; i++ ) {
+        const auto bytes = degree[i]*static_cast<redev::GO>(sizeof(T));
+        stats->bytesSentPerDest[i] += bytes;
+        stats->bytesSent += bytes;
+        stats->messagesSent += (degree[i] > 0);
+      }
+      if(commmatrix::Enabled()) {
+        GOs bytes(degree);
+        for(auto& b : bytes) b *= static_cast<redev::GO>(sizeof(T));
+        std::size_t step;
+        {
+          auto engLock = LockEngine();
+          step = eng.CurrentStep();
+        }
+        commmatrix::Record(name, step, bytes);
+      }
       GOs rdvRankStart(recvRanks,0);
       auto ret = MPI_Exscan(degree.data(), rdvRankStart.data(), recvRanks,
           getMpiType(redev::GO()), MPI_SUM, comm);
@@ -224,8 +310,18 @@ class AdiosComm : public Communicator<T> {
       adios2::Dims shape{static_cast<size_t>(gDegreeTot)};
       adios2::Dims start{};
       adios2::Dims count{};
+      //the collectives above run concurrently in the thread-safe mode, the
+      //engine calls below do not
+      auto engLock = LockEngine();
       if(!rdvVar) {
         rdvVar = io.DefineVariable<T>(name, shape, start, count);
+#if ADIOS2_VERSION_MAJOR * 100 + ADIOS2_VERSION_MINOR >= 208
+        //the layout, and so the message size, is fixed after the first send;
+        //all ranks make the same choice from the global message size
+        if(!compression.type.empty() &&
+            gDegreeTot*sizeof(T)/commSz >= compression.minBytes)
+          rdvVar.AddOperation(compression.type, compression.params);
+#endif
       }
       assert(rdvVar);
       const auto srcRanksName = name+"_srcRanks";
@@ -260,6 +356,7 @@ class AdiosComm : public Communicator<T> {
 
       }
 
+      auto t2 = redev::getTime();
       //assume one call to pack from each rank for now
       for( size_t i=0; i<outMsg.dest.size(); i++ ) {
         const auto destRank = outMsg.dest[i];
@@ -275,14 +372,22 @@ class AdiosComm : public Communicator<T> {
       if(mode == Mode::Synchronous) {
         eng.PerformPuts();
       }
+      auto t3 = redev::getTime();
+      trace::Record("Send metadata", t1, t2);
+      trace::Record("Send put", t2, t3);
+      stats->metadataSeconds += std::chrono::duration<double>(t2-t1).count();
+      stats->transferSeconds += std::chrono::duration<double>(t3-t2).count();
     }
     std::vector<T> Recv(Mode mode) {
       REDEV_FUNCTION_TIMER;
+      //the time is split into metadataSeconds and transferSeconds below
+      StatsTimer recvTimer(stats->recvLatency);
       int rank, commSz;
       MPI_Comm_rank(comm, &rank);
       MPI_Comm_size(comm, &commSz);
       auto t1 = redev::getTime();
 
+      auto engLock = LockEngine();
       if(!inMsg.knownSizes) {
         auto rdvRanksVar = io.InquireVariable<redev::GO>(name+"_srcRanks");
         assert(rdvRanksVar);
@@ -308,12 +413,29 @@ class AdiosComm : public Communicator<T> {
         inMsg.start = static_cast<size_t>(inMsg.offset[rank]);
         inMsg.count = static_cast<size_t>(inMsg.offset[rank+1]-inMsg.start);
         inMsg.knownSizes = true;
+        //the number of items from each sender, srcRanks[s*numRecvRanks+rank]
+        //is the start of the items from sender s in this rank's segment
+        const auto numRecvRanks = offSz-1;
+        const auto numSenders = rsrSz/numRecvRanks;
+        srcCounts.assign(numSenders, 0);
+        for(size_t s=0; s<numSenders; s++) {
+          const auto first = inMsg.srcRanks[s*numRecvRanks+rank];
+          const auto last = (s+1<numSenders) ?
+            inMsg.srcRanks[(s+1)*numRecvRanks+rank] : static_cast<redev::GO>(inMsg.count);
+          srcCounts[s] = last-first;
+        }
       }
       auto t2 = redev::getTime();
 
+      std::vector<T> msgs;
+      {
+        //allocate without holding the engine
+        UnlockEngine(engLock);
+        msgs.resize(inMsg.count);
+        engLock = LockEngine();
+      }
       auto msgsVar = io.InquireVariable<T>(name);
       assert(msgsVar);
-      std::vector<T> msgs(inMsg.count);
       if(inMsg.count) {
         //only call Get with non-zero sized reads
         msgsVar.SetSelection({{inMsg.start}, {inMsg.count}});
@@ -322,6 +444,7 @@ class AdiosComm : public Communicator<T> {
       if(mode == Mode::Synchronous) {
         eng.PerformGets();
       }
+      UnlockEngine(engLock);
 
       //if(mode == Mode::Synchronous) {
       //  eng.EndStep();
@@ -329,6 +452,18 @@ class AdiosComm : public Communicator<T> {
       auto t3 = redev::getTime();
       std::chrono::duration<double> r1 = t2-t1;
       std::chrono::duration<double> r2 = t3-t2;
+      trace::Record("Recv metadata", t1, t2);
+      trace::Record("Recv get", t2, t3);
+      stats->recvs++;
+      stats->metadataSeconds += r1.count();
+      stats->transferSeconds += r2.count();
+      stats->bytesReceivedPerSrc.resize(srcCounts.size(), 0);
+      for(size_t s=0; s<srcCounts.size(); s++) {
+        const auto bytes = srcCounts[s]*static_cast<redev::GO>(sizeof(T));
+        stats->bytesReceivedPerSrc[s] += bytes;
+        stats->bytesReceived += bytes;
+        stats->messagesReceived += (srcCounts[s] > 0);
+      }
       if(!rank && verbose) {
         fprintf(stderr, "recv knownSizes %d r1(sec.) r2(sec.) %f %f\n",
             inMsg.knownSizes, r1.count(), r2.count());
@@ -351,7 +486,32 @@ class AdiosComm : public Communicator<T> {
       assert(lvl>=0 && lvl<=5);
       verbose = lvl;
     }
+    CommStats GetStats() const final {
+      return *stats;
+    }
+    void ResetStats() final {
+      stats->Reset();
+    }
+    /**
+     * Return the statistics object that Send and Recv update. AdiosChannel
+     * keeps it to report the statistics of all its communicators.
+     */
+    std::shared_ptr<CommStats> GetSharedStats() const {
+      return stats;
+    }
   private:
+    /**
+     * Lock the engine mutex in the thread-safe mode, otherwise return a lock
+     * that owns nothing.
+     */
+    std::unique_lock<std::mutex> LockEngine() const {
+      return engMutex ? std::unique_lock<std::mutex>(*engMutex)
+                      : std::unique_lock<std::mutex>();
+    }
+    static void UnlockEngine(std::unique_lock<std::mutex>& lock) {
+      if(lock.owns_lock())
+        lock.unlock();
+    }
     MPI_Comm comm;
     int recvRanks;
     adios2::Engine& eng;
@@ -368,6 +528,11 @@ class AdiosComm : public Communicator<T> {
     int verbose;
     //receive side state
     InMessageLayout inMsg;
+    //number of items received from each sender
+    GOs srcCounts;
+    std::shared_ptr<CommStats> stats = std::make_shared<CommStats>();
+    std::shared_ptr<std::mutex> engMutex;
+    Compression compression;
 };
 
 }
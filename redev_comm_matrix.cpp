@@ -0,0 +1,179 @@
+#include "redev_comm_matrix.h"
+#include "redev.h"
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+
+namespace {
+  struct State {
+    std::mutex mutex; //protects all members
+    std::string prefix;
+    std::vector<std::string> comms;
+    std::vector<redev::LO> comm;
+    std::vector<redev::GO> step;
+    std::vector<redev::LO> dst;
+    std::vector<redev::GO> bytes;
+  };
+
+  State& state() {
+    static State s;
+    return s;
+  }
+
+  //ranks record the communicators in the order of their first Send, which
+  //differs across ranks that skip a communicator or send from several
+  //threads; gather the names to rank 0, return the newline separated union on
+  //rank 0 and the index into it of each of this rank's names on all ranks
+  std::vector<redev::LO> globalIndices(const std::vector<std::string>& local,
+      MPI_Comm comm, std::string& names) {
+    int rank, commSize;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &commSize);
+    std::string mine;
+    for(const auto& name : local)
+      mine += name + "\n";
+    int len = static_cast<int>(mine.size());
+    std::vector<int> lens(rank ? 0 : commSize);
+    MPI_Gather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, 0, comm);
+    std::vector<int> displs(lens.size(), 0);
+    std::string all;
+    if(!rank) {
+      for(int i=1; i<commSize; i++)
+        displs[i] = displs[i-1] + lens[i-1];
+      all.resize(displs.back() + lens.back());
+    }
+    MPI_Gatherv(mine.data(), len, MPI_CHAR, all.data(), lens.data(),
+        displs.data(), MPI_CHAR, 0, comm);
+    std::vector<std::string> global;
+    std::vector<redev::LO> allIndices;
+    std::vector<int> counts(rank ? 0 : commSize, 0);
+    std::vector<int> indexDispls(counts.size(), 0);
+    if(!rank) {
+      for(int i=0; i<commSize; i++) {
+        indexDispls[i] = static_cast<int>(allIndices.size());
+        auto pos = static_cast<std::size_t>(displs[i]);
+        const auto end = pos + static_cast<std::size_t>(lens[i]);
+        while(pos < end) {
+          const auto eol = all.find('\n', pos);
+          const auto name = all.substr(pos, eol-pos);
+          auto it = std::find(global.begin(), global.end(), name);
+          allIndices.push_back(static_cast<redev::LO>(it - global.begin()));
+          if(it == global.end())
+            global.push_back(name);
+          pos = eol+1;
+        }
+        counts[i] = static_cast<int>(allIndices.size()) - indexDispls[i];
+      }
+      for(const auto& name : global)
+        names += name + "\n";
+    }
+    std::vector<redev::LO> indices(local.size());
+    MPI_Scatterv(allIndices.data(), counts.data(), indexDispls.data(),
+        redev::getMpiType(redev::LO()), indices.data(),
+        static_cast<int>(indices.size()), redev::getMpiType(redev::LO()), 0, comm);
+    return indices;
+  }
+
+  //write a global array of the entries of all ranks, offset is the index of
+  //this rank's first entry
+  template <typename T>
+  void put(adios2::IO& io, adios2::Engine& eng, const std::string& name,
+      const std::vector<T>& values, std::size_t total, std::size_t offset) {
+    auto var = io.DefineVariable<T>(name, {total}, {offset}, {values.size()});
+    if(!values.empty())
+      eng.Put(var, values.data());
+  }
+}
+
+namespace redev {
+namespace commmatrix {
+
+  std::atomic<bool> enabled{false};
+
+  void InitializeFromEnvironment() {
+    const char* prefix = std::getenv("REDEV_COMM_MATRIX");
+    if(!prefix || !*prefix || std::string(prefix) == "0")
+      return;
+    Enable(std::string(prefix) == "1" ? "redev_comm_matrix" : prefix);
+  }
+
+  void Enable(const std::string& prefix) {
+    auto& s = state();
+    {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.prefix = prefix;
+    }
+    enabled.store(true, std::memory_order_relaxed);
+  }
+
+  void Record(const std::string& comm, std::size_t step,
+      const redev::GOs& bytesPerDest) {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = std::find(s.comms.begin(), s.comms.end(), comm);
+    const auto index = static_cast<redev::LO>(it - s.comms.begin());
+    if(it == s.comms.end())
+      s.comms.push_back(comm);
+    for(std::size_t i=0; i<bytesPerDest.size(); i++) {
+      if(!bytesPerDest[i])
+        continue;
+      s.comm.push_back(index);
+      s.step.push_back(static_cast<redev::GO>(step));
+      s.dst.push_back(static_cast<redev::LO>(i));
+      s.bytes.push_back(bytesPerDest[i]);
+    }
+  }
+
+  void Write(adios2::ADIOS& adios, MPI_Comm comm, bool isServer) {
+    REDEV_FUNCTION_TIMER;
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if(!Enabled() || comm == MPI_COMM_NULL || finalized)
+      return;
+    enabled.store(false, std::memory_order_relaxed);
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    std::string comms;
+    const auto indices = globalIndices(s.comms, comm, comms);
+    for(auto& index : s.comm)
+      index = indices[index];
+
+    const auto count = static_cast<redev::GO>(s.comm.size());
+    redev::GO offset = 0;
+    redev::GO total = 0;
+    MPI_Exscan(&count, &offset, 1, getMpiType(count), MPI_SUM, comm);
+    if(!rank)
+      offset = 0;
+    MPI_Allreduce(&count, &total, 1, getMpiType(count), MPI_SUM, comm);
+    const std::vector<redev::LO> src(s.comm.size(), rank);
+
+    const auto path = s.prefix + (isServer ? "_server.bp" : "_client.bp");
+    auto io = adios.DeclareIO("redev communication matrix");
+    io.SetEngine("BP4");
+    auto eng = io.Open(path, adios2::Mode::Write);
+    REDEV_ALWAYS_ASSERT(eng);
+    eng.BeginStep();
+    auto commsVar = io.DefineVariable<std::string>("comms");
+    if(!rank)
+      eng.Put(commsVar, comms);
+    const auto tot = static_cast<std::size_t>(total);
+    const auto off = static_cast<std::size_t>(offset);
+    put(io, eng, "comm", s.comm, tot, off);
+    put(io, eng, "step", s.step, tot, off);
+    put(io, eng, "src", src, tot, off);
+    put(io, eng, "dst", s.dst, tot, off);
+    put(io, eng, "bytes", s.bytes, tot, off);
+    eng.PerformPuts();
+    eng.EndStep();
+    eng.Close();
+    s.comms.clear();
+    s.comm.clear();
+    s.step.clear();
+    s.dst.clear();
+    s.bytes.clear();
+  }
+
+}
+}
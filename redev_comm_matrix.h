@@ -0,0 +1,69 @@
+#ifndef REDEV_REDEV_COMM_MATRIX_H
+#define REDEV_REDEV_COMM_MATRIX_H
+#include "redev_types.h"
+#include <adios2.h>
+#include <mpi.h>
+#include <atomic>
+#include <string>
+
+namespace redev {
+namespace commmatrix {
+
+/**
+ * Communication matrix capture records, for each call to AdiosComm::Send, the
+ * bytes the calling rank sends to each rank of the receiving application. It
+ * is enabled by setting the REDEV_COMM_MATRIX environment variable on all
+ * ranks to a file prefix, or to 1 for the prefix "redev_comm_matrix", before
+ * the Redev object is created.
+ *
+ * Redev::Finalize, or the Redev destructor if it was not called, has the ranks
+ * of each application write the non-zero entries of the matrices to
+ * <prefix>_server.bp or <prefix>_client.bp with the ADIOS2 BP4 engine as the
+ * global arrays "comm", "step", "src", "dst", and "bytes" of equal length.
+ * "comm" indexes the newline separated communicator names in the string
+ * variable "comms" and "step" is the ADIOS2 step of the sending engine.
+ * util_commMatrixSummary prints the imbalance, fan-in, and hot receivers of
+ * each communicator.
+ */
+
+/// when true Send records its row, see Enabled()
+extern std::atomic<bool> enabled;
+
+[[nodiscard]] inline bool Enabled() noexcept {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Enable capture if the REDEV_COMM_MATRIX environment variable is set. Called
+ * by the Redev constructor.
+ */
+void InitializeFromEnvironment();
+
+/**
+ * Enable capture.
+ * @param[in] prefix the prefix of the output files
+ */
+void Enable(const std::string &prefix);
+
+/**
+ * Record the row of the calling rank for one send.
+ * @param[in] comm the name of the communicator
+ * @param[in] step the step of the sending engine
+ * @param[in] bytesPerDest the bytes sent to each receiving rank
+ */
+void Record(const std::string &comm, std::size_t step,
+            const redev::GOs &bytesPerDest);
+
+/**
+ * Write the recorded entries of all ranks in comm and disable capture.
+ * Collective on comm if capture is enabled, otherwise it does nothing.
+ * @param[in] adios the ADIOS2 object used to open the file
+ * @param[in] comm the ranks of the application
+ * @param[in] isServer true on the server ranks
+ */
+void Write(adios2::ADIOS &adios, MPI_Comm comm, bool isServer);
+
+} // namespace commmatrix
+} // namespace redev
+
+#endif // REDEV_REDEV_COMM_MATRIX_H
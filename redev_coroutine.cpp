@@ -0,0 +1,68 @@
+#include "redev_coroutine.h"
+#include "redev_profile.h"
+#include <chrono>
+#include <thread> //std::this_thread::sleep_for
+
+namespace redev {
+namespace coro {
+
+Executor::Executor(MPI_Comm comm, double pollSeconds)
+    : comm_(comm), poll_seconds_(pollSeconds) {
+  REDEV_FUNCTION_TIMER;
+  REDEV_ALWAYS_ASSERT(comm != MPI_COMM_NULL);
+  REDEV_ALWAYS_ASSERT(pollSeconds >= 0);
+}
+
+void Executor::Spawn(Task<void> task) {
+  REDEV_FUNCTION_TIMER;
+  REDEV_ALWAYS_ASSERT(!task.Done());
+  REDEV_ALWAYS_ASSERT(task.handle_.promise().executor == nullptr);
+  task.handle_.promise().executor = this;
+  ready_.push_back(task.handle_);
+  tasks_.push_back(std::move(task));
+}
+
+void Executor::Schedule(std::coroutine_handle<> h) {
+  ready_.push_back(h);
+}
+
+void Executor::Register(detail::Pollable *p) {
+  pending_.push_back(p);
+}
+
+void Executor::Run() {
+  REDEV_FUNCTION_TIMER;
+  while (!ready_.empty() || !pending_.empty()) {
+    while (!ready_.empty()) {
+      auto h = ready_.front();
+      ready_.pop_front();
+      h.resume();
+    }
+    if (pending_.empty())
+      break;
+    // the operations were registered in the same order on all ranks; resume
+    // the ones that are complete on every rank
+    std::vector<int> done(pending_.size());
+    for (std::size_t i = 0; i < pending_.size(); i++)
+      done[i] = pending_[i]->Poll();
+    MPI_Allreduce(MPI_IN_PLACE, done.data(), static_cast<int>(done.size()),
+                  MPI_INT, MPI_MIN, comm_);
+    std::vector<detail::Pollable *> waiting;
+    for (std::size_t i = 0; i < pending_.size(); i++) {
+      if (done[i])
+        ready_.push_back(pending_[i]->handle);
+      else
+        waiting.push_back(pending_[i]);
+    }
+    pending_.swap(waiting);
+    if (ready_.empty())
+      std::this_thread::sleep_for(std::chrono::duration<double>(poll_seconds_));
+  }
+  auto tasks = std::move(tasks_);
+  tasks_.clear();
+  for (const auto &task : tasks)
+    task.handle_.promise().Rethrow();
+}
+
+} // namespace coro
+} // namespace redev
@@ -0,0 +1,316 @@
+#ifndef REDEV_REDEV_COROUTINE_H
+#define REDEV_REDEV_COROUTINE_H
+#if !defined(REDEV_ENABLE_COROUTINES) || !defined(__cpp_impl_coroutine)
+#error "redev_coroutine.h requires C++20, configure redev with REDEV_ENABLE_COROUTINES=ON"
+#endif
+#include "redev.h"
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <type_traits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace redev {
+namespace coro {
+
+/**
+ * C++20 coroutine layer over Channel and BidirectionalComm. A coupling loop
+ * is written as a coroutine returning Task and suspends, with co_await, where
+ * it waits for the other application; a single-threaded Executor then runs
+ * the other tasks of the rank, e.g., the loops of other channels or local
+ * compute, until the operation is ready:
+ * \code
+ * redev::coro::Task<> couple(redev::Channel& channel, redev::BidirectionalComm<redev::LO>& c) {
+ *   redev::coro::AsyncChannel ch(channel);
+ *   redev::coro::AsyncComm<redev::LO> comm(channel, c);
+ *   for(int step=0; step<steps; step++) {
+ *     co_await comm.AsyncSend(msgs.data());
+ *     co_await ch.AsyncEndSendPhase();
+ *     auto reply = co_await comm.AsyncRecv(redev::Mode::Synchronous);
+ *     co_await ch.AsyncEndReceivePhase();
+ *   }
+ * }
+ * redev::coro::Executor executor(rdv.GetMPIComm());
+ * executor.Spawn(couple(channel0, comm0));
+ * executor.Spawn(couple(channel1, comm1));
+ * executor.Run();
+ * \endcode
+ * The executor polls the suspended operations, the receive phase of a
+ * channel with Channel::TryBeginReceiveCommunicationPhase and MPI requests
+ * with MPI_Test, and resumes an operation only when it is ready on all ranks
+ * of its communicator. So every rank resumes the tasks in the same order and
+ * the collectives in Send, Recv, and the engine steps match across ranks.
+ * The other operations, e.g., Send and ending a phase, run to completion
+ * when awaited.
+ */
+
+class Executor;
+template <typename T = void> class Task;
+
+namespace detail {
+/// state shared by the promises of all tasks
+struct PromiseBase {
+  Executor *executor = nullptr;
+  // the coroutine awaiting this task, resumed when it completes
+  std::coroutine_handle<> continuation;
+  std::exception_ptr exception;
+  void Rethrow() const {
+    if (exception)
+      std::rethrow_exception(exception);
+  }
+};
+
+template <typename T> struct Promise : PromiseBase {
+  std::optional<T> value;
+  void return_value(T v) { value.emplace(std::move(v)); }
+  T Result() {
+    Rethrow();
+    return std::move(*value);
+  }
+};
+
+template <> struct Promise<void> : PromiseBase {
+  void return_void() noexcept {}
+  void Result() const { Rethrow(); }
+};
+
+/**
+ * An operation the executor polls while the awaiting coroutine is
+ * suspended.
+ */
+class Pollable {
+public:
+  virtual ~Pollable() = default;
+  /**
+   * Try to make progress, return true once the operation completed on this
+   * rank. Called on all ranks in the same order; it may be collective.
+   */
+  virtual bool Poll() = 0;
+  std::coroutine_handle<> handle;
+};
+
+/**
+ * Awaiter of a Pollable: always suspends and registers the operation with the
+ * executor of the awaiting task. Polling first could resume the task on some
+ * ranks only.
+ */
+class PollAwaiter : public Pollable {
+public:
+  bool await_ready() { return false; }
+  template <typename P> void await_suspend(std::coroutine_handle<P> awaiting);
+  void await_resume() const noexcept {}
+};
+} // namespace detail
+
+/**
+ * A lazily started coroutine that produces a T. Await it from another task or
+ * pass it to Executor::Spawn.
+ */
+template <typename T> class [[nodiscard]] Task {
+public:
+  struct promise_type : detail::Promise<T> {
+    Task get_return_object() {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    auto final_suspend() noexcept {
+      struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+          if (auto c = h.promise().continuation)
+            return c;
+          return std::noop_coroutine();
+        }
+        void await_resume() noexcept {}
+      };
+      return FinalAwaiter{};
+    }
+    void unhandled_exception() { this->exception = std::current_exception(); }
+  };
+  Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+  Task &operator=(Task &&) = delete;
+  ~Task() {
+    if (handle_)
+      handle_.destroy();
+  }
+  [[nodiscard]] bool Done() const noexcept { return !handle_ || handle_.done(); }
+  // awaiting a task starts it on the executor of the awaiting task
+  bool await_ready() const noexcept { return false; }
+  template <typename P>
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<P> awaiting) {
+    handle_.promise().executor = awaiting.promise().executor;
+    handle_.promise().continuation = awaiting;
+    return handle_;
+  }
+  T await_resume() { return handle_.promise().Result(); }
+
+private:
+  friend class Executor;
+  explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+  std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * Runs tasks on one thread, resuming them when the operations they await are
+ * ready on all ranks of the communicator. All ranks of the communicator spawn
+ * the same tasks in the same order and call Run.
+ */
+class Executor {
+public:
+  /**
+   * @param[in] comm the ranks of the application, typically Redev::GetMPIComm
+   * @param[in] pollSeconds the time to sleep after a poll found no operation
+   * ready and no task could run
+   */
+  explicit Executor(MPI_Comm comm, double pollSeconds = 1e-4);
+  Executor(const Executor &) = delete;
+  Executor &operator=(const Executor &) = delete;
+  /**
+   * Add a task; it starts at the next call to Run.
+   */
+  void Spawn(Task<void> task);
+  /**
+   * Run the spawned tasks until all of them completed and rethrow the first
+   * exception a task threw. Collective over the communicator.
+   */
+  void Run();
+  /// resume h after the tasks that are ready now, see Yield
+  void Schedule(std::coroutine_handle<> h);
+  /// poll p until it is ready on all ranks, then resume p->handle
+  void Register(detail::Pollable *p);
+
+private:
+  MPI_Comm comm_;
+  double poll_seconds_;
+  std::vector<Task<void>> tasks_;
+  std::deque<std::coroutine_handle<>> ready_;
+  std::vector<detail::Pollable *> pending_;
+};
+
+template <typename P>
+void detail::PollAwaiter::await_suspend(
+    std::coroutine_handle<P> awaiting) {
+  static_assert(std::is_base_of_v<detail::PromiseBase, P>,
+                "redev::coro awaitables can only be awaited from a Task");
+  REDEV_ALWAYS_ASSERT(awaiting.promise().executor);
+  handle = awaiting;
+  awaiting.promise().executor->Register(this);
+}
+
+/**
+ * Suspend the task and let the other ready tasks run, e.g., between chunks
+ * of local compute.
+ */
+struct Yield {
+  bool await_ready() const noexcept { return false; }
+  template <typename P> void await_suspend(std::coroutine_handle<P> awaiting) {
+    awaiting.promise().executor->Schedule(awaiting);
+  }
+  void await_resume() const noexcept {}
+};
+
+/**
+ * Wait for a nonblocking MPI operation, e.g., from MPI_Iallreduce issued
+ * before a local compute.
+ */
+class Wait : public detail::PollAwaiter {
+public:
+  explicit Wait(MPI_Request &request) : request_(request) {}
+  bool Poll() final {
+    if (!done_) {
+      int flag = 0;
+      MPI_Test(&request_, &flag, MPI_STATUS_IGNORE);
+      done_ = flag;
+    }
+    return done_;
+  }
+
+private:
+  MPI_Request &request_;
+  bool done_ = false;
+};
+
+/**
+ * Wait until the other application ended its send phase on the channel and
+ * begin the receive phase.
+ */
+class BeginReceivePhase : public detail::PollAwaiter {
+public:
+  explicit BeginReceivePhase(Channel &channel) : channel_(channel) {}
+  bool Poll() final {
+    if (!done_)
+      done_ = channel_.TryBeginReceiveCommunicationPhase(0.0f);
+    return done_;
+  }
+
+private:
+  Channel &channel_;
+  bool done_ = false;
+};
+
+/**
+ * Awaitable communication phases of a Channel. Only the begin of a receive
+ * phase suspends the task; the other calls run when awaited.
+ */
+class AsyncChannel {
+public:
+  explicit AsyncChannel(Channel &channel) : channel_(channel) {}
+  Task<> AsyncBeginSendPhase() {
+    channel_.BeginSendCommunicationPhase();
+    co_return;
+  }
+  Task<> AsyncEndSendPhase() {
+    channel_.EndSendCommunicationPhase();
+    co_return;
+  }
+  BeginReceivePhase AsyncBeginReceivePhase() {
+    return BeginReceivePhase(channel_);
+  }
+  Task<> AsyncEndReceivePhase() {
+    channel_.EndReceiveCommunicationPhase();
+    co_return;
+  }
+  [[nodiscard]] Channel &GetChannel() noexcept { return channel_; }
+
+private:
+  Channel &channel_;
+};
+
+/**
+ * Awaitable Send and Recv of a BidirectionalComm created from channel. They
+ * begin the send or receive phase of the channel if it is not active; the
+ * caller ends it, see AsyncChannel.
+ */
+template <typename T> class AsyncComm {
+public:
+  AsyncComm(Channel &channel, BidirectionalComm<T> &comm)
+      : channel_(channel), comm_(comm) {}
+  Task<> AsyncSend(T *msgs, Mode mode = Mode::Deferred) {
+    if (!channel_.InSendCommunicationPhase())
+      channel_.BeginSendCommunicationPhase();
+    comm_.Send(msgs, mode);
+    co_return;
+  }
+  /**
+   * With Mode::Deferred the returned messages are valid after the receive
+   * phase ended.
+   */
+  Task<std::vector<T>> AsyncRecv(Mode mode = Mode::Deferred) {
+    if (!channel_.InReceiveCommunicationPhase())
+      co_await BeginReceivePhase(channel_);
+    co_return comm_.Recv(mode);
+  }
+
+private:
+  Channel &channel_;
+  BidirectionalComm<T> &comm_;
+};
+
+} // namespace coro
+} // namespace redev
+#endif // REDEV_REDEV_COROUTINE_H
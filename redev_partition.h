@@ -1,6 +1,11 @@
 #ifndef REDEV_REDEV_PARTITION_H
 #define REDEV_REDEV_PARTITION_H
+#include "redev_shared_array.h"
 #include <adios2.h>
+#include <array>
+#include <list>
+#include <map>
+#include <type_traits>
 #include <variant>
 namespace redev {
 
@@ -9,10 +14,11 @@ namespace redev {
  * Redev for sharing partition information among the server and client
  * processes. Instances of the PartitionInterface class define an interface
  * (i.e., GetRank(...)) to query which process owns a point in the domain
- * (RCBPtn) or a given geometric model entity (ClassPtn). Defining the cut tree
- * for RCB or the assignment of ranks to geometric model entities is not the
- * purpose/responsiblity of this class or the RCBPtn and ClassPtn derived
- * classes.
+ * (RCBPtn, GridPtn, SFCPtn) or a given geometric model entity (ClassPtn).
+ * Defining the cut tree for RCB, the grid cell ownership, the curve splitters,
+ * or the assignment of ranks to geometric model entities is not the
+ * purpose/responsiblity of this class or the RCBPtn, GridPtn, SFCPtn, and
+ * ClassPtn derived classes.
  * @note this class is for exposition only
  */
 class PartitionInterface {
@@ -66,7 +72,11 @@ public:
   ClassPtn();
   /**
    * Create a ClassPtn object from a vector of owning ranks and geometric model
-   * entities.
+   * entities. Each rank may pass a different subset of the assignment; the
+   * subsets are exchanged with MPI_Allgatherv and every rank merges them into
+   * the complete table. An entity passed by multiple ranks must be assigned to
+   * the same owner.
+   * Collective on comm.
    * @param[in] comm MPI communicator containing the ranks that need the
    * partition information
    * @param[in] ranks vector of ranks owning each geometric model entity
@@ -81,6 +91,29 @@ public:
   void Write(adios2::Engine &eng, adios2::IO &io);
   void Read(adios2::Engine &eng, adios2::IO &io);
   void Broadcast(MPI_Comm comm, int root = 0);
+  /**
+   * Send the partition information from the root rank to one rank per node
+   * that stores it in an MPI shared memory window mapped by the other ranks of
+   * the node.
+   * @param[in] comm MPI communicator containing the ranks that need the
+   * partition information
+   * @param[in] root the source rank that sends the partition information
+   */
+  void BroadcastNodeShared(MPI_Comm comm, int root = 0);
+  /**
+   * Read the partition on root and store it as BroadcastNodeShared(...) does.
+   * Unlike Read(...) on root followed by BroadcastNodeShared(...), the node
+   * shared arrays of the current partition are released on all ranks at the
+   * same point, after root read the new one.
+   * Collective on comm.
+   * @param[in] eng an ADIOS2 Engine opened in read mode
+   * @param[in] io the ADIOS2 IO object that created eng
+   * @param[in] comm MPI communicator containing the ranks that need the
+   * partition information
+   * @param[in] root the rank that reads the partition
+   */
+  void ReadNodeShared(adios2::Engine &eng, adios2::IO &io, MPI_Comm comm,
+                      int root = 0);
   /**
    * Return the vector of owning ranks for all geometric model entity.
    */
@@ -93,32 +126,25 @@ public:
 private:
   const std::string entsAndRanksVarName = "class partition ents and ranks";
   /**
-   * return a vector with the contents of the ModelEntToRank map
-   * the map is serialized as [dim_0, id_0, rank_0, dim_1, id_1, rank_1, ...,
-   * dim_n-1, id_n-1, rank_n-1]
+   * Return the table written by Write(...).
    */
-  void Gather(MPI_Comm comm, int root = 0);
+  [[nodiscard]] redev::LOs ReadTable(adios2::Engine &eng, adios2::IO &io) const;
   /**
-   * return a vector with the contents of the ModelEntToRank map
-   * the map is serialized as [dim_0, id_0, rank_0, dim_1, id_1, rank_1, ...,
-   * dim_n-1, id_n-1, rank_n-1]
+   * Exchange the locally sorted table of every rank in comm and merge them
+   * into the complete table on all ranks.
    */
-  [[nodiscard]] redev::LOs SerializeModelEntsAndRanks() const;
-  /**
-   * Given a vector that contains the owning ranks and geometric model entities
-   * [dim_0, id_0, rank_0, dim_1, id_1, rank_1, ..., dim_n-1, id_n-1, rank_n-1]
-   * construct the ModelEntToRank map
-   */
-  [[nodiscard]] ModelEntToRank
-  DeserializeModelEntsAndRanks(const redev::LOs &serialized) const;
+  void AllGather(MPI_Comm comm);
   /**
    * Ensure that the dimensions of the model ents is [0:3]
    */
   [[nodiscard]] bool ModelEntDimsValid(const ModelEntVec &ents) const;
   /**
-   * The map of geometric model entities to their owning rank
+   * The owning rank of each geometric model entity stored as
+   * [dim_0, id_0, rank_0, dim_1, id_1, rank_1, ..., dim_n-1, id_n-1, rank_n-1]
+   * and sorted by (dim,id). This is also the layout that is written to ADIOS2
+   * and broadcast, so no conversion is needed when the table is sent.
    */
-  ModelEntToRank modelEntToRank;
+  SharedArray<redev::LO> entsAndRanks;
 };
 
 /**
@@ -135,6 +161,8 @@ private:
  * breath-first traversal order starting at the root and visiting the child
  * nodes at each level from left to right. The root of the cut tree is stored at
  * index 1 and index 0 is unused. See test_query.cpp for examples.
+ * BuildRCBPtn creates a balanced cut tree from a distributed set of weighted
+ * points.
  */
 class RCBPtn {
 public:
@@ -154,6 +182,10 @@ public:
    * @param[in] cuts vector of 2-vectors or 3-vectors, for 2d and 3d domains
    * respectively, defining the cut tree. The 2-vectors (3-vectors) are stored
    * in the vector as (x0,y0(,z0),x1,y1(,z1),...xN-1,yN-1(,zN-1))
+   *
+   * The number of ranks and cuts must be the same power of two to find the
+   * owners of points or boxes; other sizes are accepted, e.g., for partitions
+   * that are never queried, and the queries fail.
    */
   RCBPtn(redev::LO dim, std::vector<int> &ranks, std::vector<double> &cuts);
   /**
@@ -162,9 +194,74 @@ public:
    * domains.
    */
   redev::LO GetRank(std::array<redev::Real, 3> &pt) const;
+  /**
+   * Return the rank owning each of the given points. The traversal is
+   * specialized for the dimension of the partition once per call.
+   * @param[in] pts the cartesian points stored as (x0,y0,z0,x1,y1,z1,...); z is
+   * ignored for 2d domains and y and z for 1d domains
+   */
+  [[nodiscard]] redev::LOs GetRank(const redev::Reals &pts) const;
+  /**
+   * Return the rank owning each of the given single precision points.
+   * Comparing the points against the double precision cuts gives the same
+   * owners as converting the points to double first.
+   * @param[in] pts the cartesian points in the same layout as above
+   */
+  [[nodiscard]] redev::LOs GetRank(const std::vector<float> &pts) const;
+  /**
+   * Return the ranks owning a sub-domain that overlaps the given axis aligned
+   * box. The ranks are sorted and unique. Like GetRank, a point on a cut is
+   * owned by the sub-domain above the cut.
+   * @param[in] boxMin the lower corner of the box, the 3rd value is ignored for
+   * 2d domains
+   * @param[in] boxMax the upper corner of the box
+   */
+  [[nodiscard]] redev::LOs
+  GetRanks(const std::array<redev::Real, 3> &boxMin,
+           const std::array<redev::Real, 3> &boxMax) const;
+  /**
+   * The ranks overlapping each box of a batched query, stored in compressed
+   * sparse row format: the ranks of box i are
+   * ranks[offsets[i]] ... ranks[offsets[i+1]-1].
+   */
+  struct BoxRanks {
+    redev::LOs offsets;
+    redev::LOs ranks;
+  };
+  /**
+   * Return the ranks overlapping each box.
+   * @param[in] boxMins the lower corners of the boxes stored as
+   * (x0,y0,z0,x1,y1,z1,...); z is ignored for 2d domains
+   * @param[in] boxMaxs the upper corners of the boxes in the same layout
+   */
+  [[nodiscard]] BoxRanks GetRanks(const redev::Reals &boxMins,
+                                  const redev::Reals &boxMaxs) const;
   void Write(adios2::Engine &eng, adios2::IO &io);
   void Read(adios2::Engine &eng, adios2::IO &io);
   void Broadcast(MPI_Comm comm, int root = 0);
+  /**
+   * Send the partition information from the root rank to one rank per node
+   * that stores it in an MPI shared memory window mapped by the other ranks of
+   * the node.
+   * @param[in] comm MPI communicator containing the ranks that need the
+   * partition information
+   * @param[in] root the source rank that sends the partition information
+   */
+  void BroadcastNodeShared(MPI_Comm comm, int root = 0);
+  /**
+   * Read the partition on root and store it as BroadcastNodeShared(...) does.
+   * Unlike Read(...) on root followed by BroadcastNodeShared(...), the node
+   * shared arrays of the current partition are released on all ranks at the
+   * same point, after root read the new one.
+   * Collective on comm.
+   * @param[in] eng an ADIOS2 Engine opened in read mode
+   * @param[in] io the ADIOS2 IO object that created eng
+   * @param[in] comm MPI communicator containing the ranks that need the
+   * partition information
+   * @param[in] root the rank that reads the partition
+   */
+  void ReadNodeShared(adios2::Engine &eng, adios2::IO &io, MPI_Comm comm,
+                      int root = 0);
   /**
    * Return the vector of owning ranks for each sub-domain of the cut tree.
    */
@@ -176,15 +273,333 @@ public:
   [[nodiscard]] std::vector<redev::Real> GetCuts() const;
 
 private:
+  /**
+   * Append the ranks of the leaves overlapping the box to boxRanks, unsorted
+   * and possibly repeated.
+   */
+  void AppendLeafRanks(const redev::Real *boxMin, const redev::Real *boxMax,
+                       redev::LOs &boxRanks) const;
+  template <typename T>
+  [[nodiscard]] redev::LOs GetRankBatch(const std::vector<T> &pts) const;
+  /**
+   * Compute the depth of the cut tree from the number of cuts. Called each
+   * time the cuts are set.
+   */
+  void Init();
+  /**
+   * Fail unless the tree can be queried, see the RCBPtn constructor.
+   */
+  void CheckTree() const;
+  /**
+   * Read the dimension, owning ranks, and cuts written by Write(...).
+   */
+  void ReadTree(adios2::Engine &eng, adios2::IO &io, redev::LOs &ranks_,
+                redev::Reals &cuts_);
   const std::string ranksVarName = "rcb partition ranks";
   const std::string cutsVarName = "rcb partition cuts";
   const std::string dimVarName = "rcb partition dim";
+  redev::LO dim = 0;
+  /**
+   * depth of the cut tree, the number of cuts on the path from the root to a
+   * leaf; -1 if the tree can not be queried, see CheckTree
+   */
+  int levels = 0;
+  SharedArray<redev::LO> ranks;
+  SharedArray<redev::Real> cuts;
+};
+
+/**
+ * The GridPtn class supports a domain partition defined by a uniform cartesian
+ * grid. The user passes to the constructor the origin of the grid, the cell
+ * spacing and number of cells along each axis, and the rank owning each cell.
+ * Cells are numbered with the x index varying fastest, then y, then z.  Points
+ * outside of the grid are assigned to the nearest boundary cell so, like
+ * RCBPtn, every point in space has an owner.  Finding the owner of a point
+ * requires a few multiplies and no tree traversal.
+ */
+class GridPtn {
+public:
+  GridPtn();
+  /**
+   * Create a GridPtn object.
+   * @param[in] dim the dimension of the domain (1=1d,2=2d,3=3d)
+   * @param[in] origin the coordinates of the lower corner of the grid, values
+   * beyond dim are ignored
+   * @param[in] spacing the width of a cell along each axis, values beyond dim
+   * are ignored
+   * @param[in] cells the number of cells along each axis, values beyond dim
+   * are ignored
+   * @param[in] ranks vector of ranks owning each cell, the length must equal
+   * the product of the first dim entries of cells
+   */
+  GridPtn(redev::LO dim, const std::array<redev::Real, 3> &origin,
+          const std::array<redev::Real, 3> &spacing,
+          const std::array<redev::LO, 3> &cells, const redev::LOs &ranks);
+  /**
+   * Return the rank owning the given point.
+   * @param[in] pt the cartesian point in space. Values beyond dim are ignored,
+   * the others must be finite.
+   */
+  [[nodiscard]] redev::LO GetRank(const std::array<redev::Real, 3> &pt) const;
+  /**
+   * Return the rank owning each of the given points.
+   * @param[in] pts the cartesian points stored as (x0,y0,z0,x1,y1,z1,...).
+   * Three values are stored for each point regardless of dim, the first dim
+   * values of each point must be finite.
+   */
+  [[nodiscard]] redev::LOs GetRank(const redev::Reals &pts) const;
+  void Write(adios2::Engine &eng, adios2::IO &io);
+  void Read(adios2::Engine &eng, adios2::IO &io);
+  void Broadcast(MPI_Comm comm, int root = 0);
+  /**
+   * Return the vector of owning ranks for each cell of the grid.
+   */
+  [[nodiscard]] redev::LOs GetRanks() const;
+  /**
+   * Return the coordinates of the lower corner of the grid.
+   */
+  [[nodiscard]] std::array<redev::Real, 3> GetOrigin() const;
+  /**
+   * Return the width of a cell along each axis.
+   */
+  [[nodiscard]] std::array<redev::Real, 3> GetSpacing() const;
+  /**
+   * Return the number of cells along each axis.
+   */
+  [[nodiscard]] std::array<redev::LO, 3> GetCells() const;
+
+private:
+  const std::string ranksVarName = "grid partition ranks";
+  const std::string geomVarName = "grid partition origin and spacing";
+  const std::string cellsVarName = "grid partition cells";
+  const std::string dimVarName = "grid partition dim";
+  /**
+   * set the unused axes to a single cell and compute the inverse spacing
+   */
+  void Init();
+  /**
+   * return the index of the cell containing the point along axis d
+   */
+  [[nodiscard]] redev::LO CellIndex(redev::Real x, int d) const;
   redev::LO dim;
-  std::vector<redev::LO> ranks;
-  std::vector<redev::Real> cuts;
+  std::array<redev::Real, 3> origin;
+  std::array<redev::Real, 3> spacing;
+  std::array<redev::Real, 3> invSpacing;
+  std::array<redev::LO, 3> cells;
+  redev::LOs ranks;
 };
 
-using Partition = std::variant<ClassPtn, RCBPtn>;
+/**
+ * The SFCPtn class supports a domain partition defined by contiguous segments
+ * of a Morton (Z-order) space filling curve over a bounding box.  Each point
+ * is mapped to a key by quantizing its coordinates within the box (points
+ * outside are clamped to the box) and interleaving the bits of the quantized
+ * coordinates.  The user passes to the constructor the sorted splitter keys;
+ * splitters[i] is the first key of the segment owned by ranks[i] and the
+ * segment extends up to, but not including, splitters[i+1].  Keys smaller than
+ * splitters[0] are owned by ranks[0].  The table is two short vectors, so it is
+ * cheap to send and store, and the owners of a batch of points sorted along
+ * the curve are found with one sequential pass over the splitters.
+ */
+class SFCPtn {
+public:
+  /**
+   * Position of a point along the space filling curve.
+   */
+  using Key = std::uint64_t;
+  /**
+   * Vector of keys.
+   */
+  using Keys = std::vector<Key>;
+  SFCPtn();
+  /**
+   * Create a SFCPtn object.
+   * @param[in] dim the dimension of the domain (1=1d,2=2d,3=3d)
+   * @param[in] boxMin the lower corner of the bounding box
+   * @param[in] boxMax the upper corner of the bounding box
+   * @param[in] splitters sorted vector of the first key of each segment
+   * @param[in] ranks vector of ranks owning each segment
+   */
+  SFCPtn(redev::LO dim, const std::array<redev::Real, 3> &boxMin,
+         const std::array<redev::Real, 3> &boxMax, const Keys &splitters,
+         const redev::LOs &ranks);
+  /**
+   * Return the key of the given point.
+   * @param[in] pt the cartesian point in space. Values beyond dim are ignored.
+   */
+  [[nodiscard]] Key GetKey(const std::array<redev::Real, 3> &pt) const;
+  /**
+   * Return the key of each of the given points.
+   * @param[in] pts the cartesian points stored as (x0,y0,z0,x1,y1,z1,...).
+   * Three values are stored for each point regardless of dim.
+   */
+  [[nodiscard]] Keys GetKeys(const redev::Reals &pts) const;
+  /**
+   * Return the rank owning the given point.
+   * @param[in] pt the cartesian point in space. Values beyond dim are ignored.
+   */
+  [[nodiscard]] redev::LO GetRank(const std::array<redev::Real, 3> &pt) const;
+  /**
+   * Return the rank owning each of the given points.  If the keys of the points
+   * are non-decreasing the splitters are traversed once for the whole batch.
+   * @param[in] pts the cartesian points stored as (x0,y0,z0,x1,y1,z1,...).
+   * Three values are stored for each point regardless of dim.
+   */
+  [[nodiscard]] redev::LOs GetRank(const redev::Reals &pts) const;
+  void Write(adios2::Engine &eng, adios2::IO &io);
+  void Read(adios2::Engine &eng, adios2::IO &io);
+  void Broadcast(MPI_Comm comm, int root = 0);
+  /**
+   * Return the vector of owning ranks for each segment of the curve.
+   */
+  [[nodiscard]] redev::LOs GetRanks() const;
+  /**
+   * Return the vector of splitter keys.
+   */
+  [[nodiscard]] Keys GetSplitters() const;
+  /**
+   * Return the lower corner of the bounding box.
+   */
+  [[nodiscard]] std::array<redev::Real, 3> GetBoxMin() const;
+  /**
+   * Return the upper corner of the bounding box.
+   */
+  [[nodiscard]] std::array<redev::Real, 3> GetBoxMax() const;
+
+private:
+  const std::string ranksVarName = "sfc partition ranks";
+  const std::string splittersVarName = "sfc partition splitters";
+  const std::string boxVarName = "sfc partition box";
+  const std::string dimVarName = "sfc partition dim";
+  /**
+   * compute the number of bits per axis and the quantization scale
+   */
+  void Init();
+  /**
+   * return the index of the segment containing the key
+   */
+  [[nodiscard]] std::size_t FindSegment(Key key) const;
+  redev::LO dim;
+  int bits;
+  std::array<redev::Real, 3> boxMin;
+  std::array<redev::Real, 3> boxMax;
+  std::array<redev::Real, 3> scale;
+  Keys splitters;
+  redev::LOs ranks;
+};
+
+/**
+ * The DistributedClassPtn class supports the same partition as ClassPtn,
+ * the ownership of geometric model entities, without storing the complete
+ * assignment on every rank. The (dimension, id, rank) table is hash
+ * partitioned across the ranks of a communicator so each rank stores
+ * O(entities/ranks) of it. Owners are found with the collective GetRanks(...)
+ * that answers a batch of queries with one pair of MPI_Alltoallv exchanges.
+ * An optional least recently used cache of answers avoids repeated exchanges
+ * for entities that are queried often.
+ *
+ * Unlike the other partitions, Write(...) and Read(...) are collective: each
+ * server rank writes its part of the table and each client rank reads a part
+ * and redistributes it to its own communicator.
+ */
+class DistributedClassPtn {
+public:
+  using ModelEnt = ClassPtn::ModelEnt;
+  using ModelEntVec = ClassPtn::ModelEntVec;
+  DistributedClassPtn();
+  /**
+   * Create a DistributedClassPtn object from a vector of owning ranks and
+   * geometric model entities. Each rank may pass any subset of the
+   * assignment. An entity passed by multiple ranks must be assigned to the
+   * same owner.
+   * Collective on comm.
+   * @param[in] comm MPI communicator whose ranks store and query the table,
+   * it must remain valid for the lifetime of this object
+   * @param[in] ranks vector of ranks owning each geometric model entity
+   * @param[in] ents vector of geometric model entities
+   */
+  DistributedClassPtn(MPI_Comm comm, const redev::LOs &ranks,
+                      const ModelEntVec &ents);
+  /**
+   * Return the rank owning each of the given geometric model entities.
+   * Collective on the communicator passed to the constructor or Read(...);
+   * ranks without queries must call it with an empty vector.
+   * @param[in] ents the geometric model entities
+   */
+  [[nodiscard]] redev::LOs GetRanks(const ModelEntVec &ents) const;
+  /**
+   * Set the maximum number of answered queries kept in the cache. Zero, the
+   * default, disables the cache.
+   * @param[in] capacity maximum number of cached entities
+   */
+  void SetCacheCapacity(std::size_t capacity);
+  [[nodiscard]] std::size_t GetCacheCapacity() const noexcept;
+  /**
+   * Return the number of geometric model entities stored on this rank.
+   */
+  [[nodiscard]] std::size_t GetLocalSize() const noexcept;
+  /**
+   * Write the part of the table stored on this rank to a global array.
+   * Collective on comm.
+   */
+  void Write(adios2::Engine &eng, adios2::IO &io, MPI_Comm comm);
+  /**
+   * Read an even part of the global array written by Write(...) and
+   * redistribute the entries to the ranks of comm that store them.
+   * Collective on comm.
+   */
+  void Read(adios2::Engine &eng, adios2::IO &io, MPI_Comm comm);
+  /**
+   * The table is already distributed; nothing is sent.
+   */
+  void Broadcast(MPI_Comm comm, int root = 0);
+
+private:
+  const std::string entsAndRanksVarName =
+      "distributed class partition ents and ranks";
+  /**
+   * Send the (dim,id,rank) triples to the ranks that store them and replace
+   * the local table with the received triples.
+   */
+  void Distribute(const redev::LOs &triples);
+  /**
+   * Return the rank of comm that stores the given entity.
+   */
+  [[nodiscard]] int StoringRank(ModelEnt ent) const;
+  /**
+   * Return the owner of an entity stored on this rank.
+   */
+  [[nodiscard]] redev::LO LocalRank(ModelEnt ent) const;
+  MPI_Comm comm = MPI_COMM_NULL;
+  int commSize = 1;
+  /**
+   * The part of the table stored on this rank as
+   * [dim_0, id_0, rank_0, ..., dim_n-1, id_n-1, rank_n-1] sorted by (dim,id).
+   */
+  redev::LOs entsAndRanks;
+  std::size_t cacheCapacity = 0;
+  using CacheList = std::list<std::pair<ModelEnt, redev::LO>>;
+  mutable CacheList cacheList; // most recently used first
+  mutable std::map<ModelEnt, CacheList::iterator> cacheIndex;
+};
+
+using Partition = std::variant<ClassPtn, RCBPtn, GridPtn, SFCPtn,
+                               DistributedClassPtn>;
+
+/**
+ * True for partitions whose Write(...) and Read(...) are collective over the
+ * communicator of the application instead of being called by rank 0 only.
+ */
+template <typename T> struct IsDistributedPartition : std::false_type {};
+template <>
+struct IsDistributedPartition<DistributedClassPtn> : std::true_type {};
+
+/**
+ * True for partitions that support BroadcastNodeShared(...).
+ */
+template <typename T> struct IsNodeShareablePartition : std::false_type {};
+template <> struct IsNodeShareablePartition<ClassPtn> : std::true_type {};
+template <> struct IsNodeShareablePartition<RCBPtn> : std::true_type {};
 
 } // namespace redev
 
@@ -0,0 +1,242 @@
+#include "redev.h"
+#include "redev_partition_builder.h"
+#include "redev_assert.h"
+#include "redev_exclusive_scan.h"
+#include "redev_profile.h"
+#include <algorithm> // std::min, std::max
+#include <cmath>     // std::nextafter, std::floor
+#include <functional> // std::greater
+#include <limits>    // std::numeric_limits
+#include <map>       // std::map
+#include <numeric>   // std::iota
+#include <queue>     // std::priority_queue
+
+namespace {
+  //number of histogram bins used to refine the median interval of each node
+  const int numBins = 64;
+  //number of refinements; the median is located within
+  //(max-min)/numBins^maxRefinements along the cut dimension
+  const int maxRefinements = 6;
+
+  bool isPowerOfTwo(redev::LO n) {
+    return n > 0 && (n & (n-1)) == 0;
+  }
+
+  using ModelEnt = redev::ClassPtn::ModelEnt;
+  using ModelEntVec = redev::ClassPtn::ModelEntVec;
+
+  //gather the entities and weights from all ranks to the root and sum the
+  //weights of entities passed by more than one rank
+  std::map<ModelEnt, redev::Real> gatherWeights(MPI_Comm comm,
+      const ModelEntVec& ents, const redev::Reals& weights, int root) {
+    int rank, commSize;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &commSize);
+    redev::LOs localEnts;
+    localEnts.reserve(2*ents.size());
+    for(const auto& ent : ents) {
+      localEnts.push_back(ent.first);
+      localEnts.push_back(ent.second);
+    }
+    int len = static_cast<int>(ents.size());
+    redev::LOs counts(rank==root ? commSize : 0);
+    MPI_Gather(&len, 1, MPI_INT, counts.data(), 1, MPI_INT, root, comm);
+    redev::LOs offsets(counts.size()+1, 0);
+    redev::exclusive_scan(counts.begin(), counts.end(), offsets.begin(), redev::LO(0));
+    if(rank==root) offsets.back() = offsets[commSize-1] + counts[commSize-1];
+    redev::Reals allWeights(rank==root ? offsets.back() : 0);
+    MPI_Gatherv(weights.data(), len, MPI_DOUBLE, allWeights.data(),
+        counts.data(), offsets.data(), MPI_DOUBLE, root, comm);
+    for(auto& c : counts) c *= 2;
+    for(auto& o : offsets) o *= 2;
+    redev::LOs allEnts(rank==root ? offsets.back() : 0);
+    MPI_Gatherv(localEnts.data(), 2*len, MPI_INT, allEnts.data(),
+        counts.data(), offsets.data(), MPI_INT, root, comm);
+    std::map<ModelEnt, redev::Real> entWeight;
+    for(size_t i=0; i<allWeights.size(); i++) {
+      entWeight[ModelEnt(allEnts[2*i], allEnts[2*i+1])] += allWeights[i];
+    }
+    return entWeight;
+  }
+}
+
+namespace redev {
+
+  RCBPtn BuildRCBPtn(MPI_Comm comm, redev::LO dim, const redev::Reals& pts,
+      const redev::Reals& weights, redev::LO numParts) {
+    REDEV_PHASE_TIMER("redev::BuildRCBPtn");
+    REDEV_ALWAYS_ASSERT(dim>0 && dim<=3);
+    REDEV_ALWAYS_ASSERT(pts.size()%3 == 0);
+    const auto numPts = pts.size()/3;
+    REDEV_ALWAYS_ASSERT(weights.empty() || weights.size() == numPts);
+    if(!numParts) {
+      MPI_Comm_size(comm, &numParts);
+    }
+    REDEV_ALWAYS_ASSERT(isPowerOfTwo(numParts));
+    auto weight = [&](size_t i) { return weights.empty() ? Real(1) : weights[i]; };
+
+    //the cut tree is stored breadth first with the root at index 1
+    redev::Reals cuts(numParts, 0);
+    //the node each point is in; all points start in the root
+    redev::LOs node(numPts, 1);
+    const auto inf = std::numeric_limits<Real>::infinity();
+    for(redev::LO first=1, d=0; first<numParts; first*=2, d=(d+1)%dim) {
+      const auto numNodes = first; //nodes in this level are [first:2*first)
+      //bounding interval and total weight of each node
+      redev::Reals lo(numNodes, inf);
+      redev::Reals hi(numNodes, -inf);
+      redev::Reals total(numNodes, 0);
+      for(size_t i=0; i<numPts; i++) {
+        const auto n = node[i]-first;
+        const auto x = pts[3*i+d];
+        lo[n] = std::min(lo[n], x);
+        hi[n] = std::max(hi[n], x);
+        total[n] += weight(i);
+      }
+      MPI_Allreduce(MPI_IN_PLACE, lo.data(), numNodes, MPI_DOUBLE, MPI_MIN, comm);
+      MPI_Allreduce(MPI_IN_PLACE, hi.data(), numNodes, MPI_DOUBLE, MPI_MAX, comm);
+      MPI_Allreduce(MPI_IN_PLACE, total.data(), numNodes, MPI_DOUBLE, MPI_SUM, comm);
+      //weight of the points in each node below the current interval
+      redev::Reals below(numNodes, 0);
+      //cut candidates: lo (leftWt=below) or hi (leftWt=below+binWt)
+      redev::Reals binWt(numNodes, 0);
+      for(redev::LO n=0; n<numNodes; n++) {
+        //make the interval half open so the largest coordinate is in it
+        if(hi[n] >= lo[n]) hi[n] = std::nextafter(hi[n], inf);
+      }
+      redev::Reals hist(numNodes*numBins);
+      for(int r=0; r<maxRefinements; r++) {
+        std::fill(hist.begin(), hist.end(), 0);
+        for(size_t i=0; i<numPts; i++) {
+          const auto n = node[i]-first;
+          const auto x = pts[3*i+d];
+          if(x < lo[n] || x >= hi[n]) continue;
+          const auto b = std::floor((x-lo[n])/(hi[n]-lo[n])*numBins);
+          const auto bin = std::min(static_cast<int>(b), numBins-1);
+          hist[n*numBins+bin] += weight(i);
+        }
+        MPI_Allreduce(MPI_IN_PLACE, hist.data(), hist.size(), MPI_DOUBLE, MPI_SUM, comm);
+        //narrow the interval of each node to the bin containing its median
+        for(redev::LO n=0; n<numNodes; n++) {
+          if(!(hi[n] > lo[n])) continue; //empty node
+          const auto target = total[n]/2;
+          const auto width = (hi[n]-lo[n])/numBins;
+          auto cum = below[n];
+          int b = 0;
+          for(; b<numBins-1; b++) {
+            if(cum + hist[n*numBins+b] >= target) break;
+            cum += hist[n*numBins+b];
+          }
+          below[n] = cum;
+          binWt[n] = hist[n*numBins+b];
+          const auto newLo = lo[n] + b*width;
+          hi[n] = (b == numBins-1) ? hi[n] : newLo + width;
+          lo[n] = newLo;
+        }
+      }
+      //pick the interval end that best balances the two children and move
+      //the points into the children
+      for(redev::LO n=0; n<numNodes; n++) {
+        if(!(hi[n] > lo[n])) {
+          cuts[first+n] = std::isfinite(lo[n]) ? lo[n] : 0;
+          continue;
+        }
+        const auto target = total[n]/2;
+        const auto atLo = std::abs(below[n] - target);
+        const auto atHi = std::abs(below[n] + binWt[n] - target);
+        cuts[first+n] = (atLo <= atHi) ? lo[n] : hi[n];
+      }
+      for(size_t i=0; i<numPts; i++) {
+        const auto cut = cuts[node[i]];
+        node[i] = 2*node[i] + (pts[3*i+d] < cut ? 0 : 1);
+      }
+    }
+    redev::LOs ranks(numParts);
+    std::iota(ranks.begin(), ranks.end(), 0);
+    return RCBPtn(dim, ranks, cuts);
+  }
+
+  ClassPtn BuildClassPtn(MPI_Comm comm, const ClassPtn::ModelEntVec& ents,
+      const redev::Reals& weights, redev::LO numParts,
+      const ModelEntAdjacency& adjacent, redev::Real tolerance) {
+    REDEV_PHASE_TIMER("redev::BuildClassPtn");
+    REDEV_ALWAYS_ASSERT(ents.size() == weights.size());
+    REDEV_ALWAYS_ASSERT(tolerance >= 0);
+    const int root = 0;
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    if(!numParts) {
+      MPI_Comm_size(comm, &numParts);
+    }
+    REDEV_ALWAYS_ASSERT(numParts > 0);
+    const auto entWeight = gatherWeights(comm, ents, weights, root);
+    if(rank != root) {
+      return ClassPtn(comm, {}, {});
+    }
+
+    //order the entities from heaviest to lightest, ties are broken by the
+    //entity so the assignment is deterministic
+    const auto numEnts = entWeight.size();
+    ModelEntVec allEnts;
+    redev::Reals allWeights;
+    allEnts.reserve(numEnts);
+    allWeights.reserve(numEnts);
+    std::map<ModelEnt, size_t> entIdx;
+    for(const auto& [ent, wt] : entWeight) {
+      entIdx[ent] = allEnts.size();
+      allEnts.push_back(ent);
+      allWeights.push_back(wt);
+    }
+    std::vector<size_t> order(numEnts);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+        [&](size_t a, size_t b) { return allWeights[a] > allWeights[b]; });
+
+    //adjacency lists of the entities, pairs with an unknown entity are ignored
+    std::vector<std::vector<size_t>> adj(numEnts);
+    for(const auto& [a, b] : adjacent) {
+      const auto ia = entIdx.find(a);
+      const auto ib = entIdx.find(b);
+      if(ia == entIdx.end() || ib == entIdx.end() || ia->second == ib->second) continue;
+      adj[ia->second].push_back(ib->second);
+      adj[ib->second].push_back(ia->second);
+    }
+
+    redev::Real total = 0;
+    for(auto w : allWeights) total += w;
+    const auto maxLoad = (1+tolerance)*total/numParts;
+    redev::Reals load(numParts, 0);
+    //min-heap of (load, part); entries made stale by a load change are
+    //skipped when they reach the top
+    using LoadPart = std::pair<redev::Real, redev::LO>;
+    std::priority_queue<LoadPart, std::vector<LoadPart>, std::greater<LoadPart>> heap;
+    for(redev::LO p=0; p<numParts; p++) heap.push({0, p});
+    auto leastLoaded = [&]() {
+      while(heap.top().first != load[heap.top().second]) heap.pop();
+      return heap.top().second;
+    };
+
+    redev::LOs owner(numEnts, -1);
+    std::map<redev::LO, redev::Real> affinity;
+    for(const auto e : order) {
+      auto part = leastLoaded();
+      //prefer the part holding the most weight of the adjacent entities
+      affinity.clear();
+      for(const auto n : adj[e]) {
+        if(owner[n] >= 0) affinity[owner[n]] += allWeights[n];
+      }
+      redev::Real best = 0;
+      for(const auto& [p, wt] : affinity) {
+        if(load[p] + allWeights[e] <= maxLoad && wt > best) {
+          best = wt;
+          part = p;
+        }
+      }
+      owner[e] = part;
+      load[part] += allWeights[e];
+      heap.push({load[part], part});
+    }
+    return ClassPtn(comm, owner, allEnts);
+  }
+
+} // namespace redev
@@ -0,0 +1,71 @@
+#ifndef REDEV_REDEV_PARTITION_BUILDER_H
+#define REDEV_REDEV_PARTITION_BUILDER_H
+#include "redev_types.h"
+#include "redev_partition.h"
+#include <mpi.h>
+
+namespace redev {
+
+/**
+ * Create a RCBPtn whose sub-domains hold nearly equal point weight.
+ * The cut at each node of the tree is the weighted median of the points in the
+ * node along the node's cut dimension. The medians of all the nodes in a level
+ * are found together with a parallel histogram bisection; each refinement
+ * requires one MPI_Allreduce over the histograms of the level.
+ * Collective on comm.
+ * @param[in] comm MPI communicator containing the ranks that own points
+ * @param[in] dim the dimension of the domain (1=1d,2=2d,3=3d)
+ * @param[in] pts the points owned by this rank stored as
+ * (x0,y0,z0,x1,y1,z1,...). Three values are stored for each point regardless
+ * of dim.
+ * @param[in] weights the weight of each point owned by this rank, if empty each
+ * point has a weight of one
+ * @param[in] numParts the number of sub-domains, must be a power of two; if
+ * zero the size of comm is used. Sub-domain i is owned by rank i.
+ * @return the partition, identical on all ranks of comm
+ */
+[[nodiscard]] RCBPtn BuildRCBPtn(MPI_Comm comm, redev::LO dim,
+                                 const redev::Reals &pts,
+                                 const redev::Reals &weights = {},
+                                 redev::LO numParts = 0);
+
+/**
+ * Pairs of geometric model entities that are adjacent (e.g., a model face and
+ * a model region bounded by it).
+ */
+using ModelEntAdjacency =
+    std::vector<std::pair<ClassPtn::ModelEnt, ClassPtn::ModelEnt>>;
+
+/**
+ * Create a ClassPtn that assigns geometric model entities to ranks such that
+ * the total entity weight on each rank is nearly equal.
+ * The assignment uses the longest processing time (LPT) heuristic: entities
+ * are visited from heaviest to lightest and each is given to the least loaded
+ * rank. If adjacency information is provided, an entity is instead given to
+ * the rank that already holds the most weight of its adjacent entities as long
+ * as that rank's load stays within (1+tolerance) of the average load.
+ * The assignment is computed on rank 0 of comm.
+ * Collective on comm.
+ * @param[in] comm MPI communicator containing the ranks that own entity weights
+ * @param[in] ents geometric model entities known by this rank, the same entity
+ * may be passed by multiple ranks
+ * @param[in] weights the weight of each entity (e.g., the number of mesh
+ * entities classified on it), weights of an entity passed by multiple ranks
+ * are summed
+ * @param[in] numParts the number of ranks to assign entities to; if zero the
+ * size of comm is used
+ * @param[in] adjacent pairs of adjacent entities that should be kept together
+ * when possible, only the pairs passed by rank 0 are used
+ * @param[in] tolerance the allowed load imbalance when keeping adjacent
+ * entities together
+ */
+[[nodiscard]] ClassPtn BuildClassPtn(MPI_Comm comm,
+                                     const ClassPtn::ModelEntVec &ents,
+                                     const redev::Reals &weights,
+                                     redev::LO numParts = 0,
+                                     const ModelEntAdjacency &adjacent = {},
+                                     redev::Real tolerance = 0.05);
+
+} // namespace redev
+
+#endif // REDEV_REDEV_PARTITION_BUILDER_H
@@ -0,0 +1,217 @@
+#include "redev_profile.h"
+#include "redev_assert.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+  int initialTimerLevel() {
+    int level = REDEV_TIMER_LEVEL;
+    if(const char* env = std::getenv("REDEV_TIMER_LEVEL"))
+      level = std::atoi(env);
+    return std::clamp(level, 0, REDEV_TIMER_LEVEL);
+  }
+
+  struct TimerCalls {
+    long long calls = 0;
+    std::int64_t nanoseconds = 0;
+  };
+
+  struct DoubleInt {
+    double value;
+    int rank;
+  };
+
+  //keyed by the address of the static timer name
+  using TimerTable = std::unordered_map<const char*, TimerCalls>;
+
+  struct SummaryState {
+    std::mutex mutex; //protects tables and path
+    std::vector<std::unique_ptr<TimerTable>> tables;
+    std::string path;
+  };
+
+  SummaryState& summaryState() {
+    static SummaryState s;
+    return s;
+  }
+
+  //tables are never freed so the pointer stays valid after the thread exits
+  thread_local TimerTable* localTable = nullptr;
+
+  TimerTable* registerTable() {
+    auto& s = summaryState();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.tables.push_back(std::make_unique<TimerTable>());
+    return s.tables.back().get();
+  }
+
+  bool initialSummaryEnabled() {
+    const char* env = std::getenv("REDEV_TIMER_SUMMARY");
+    if(!env || !*env || std::string(env) == "0")
+      return false;
+    if(std::string(env) != "1")
+      summaryState().path = env;
+    return true;
+  }
+
+  //names separated by null characters
+  std::string joinNames(const std::map<std::string, TimerCalls>& local) {
+    std::string names;
+    for(const auto& [name, calls] : local) {
+      names += name;
+      names += '\0';
+    }
+    return names;
+  }
+}
+
+namespace redev {
+
+  namespace detail {
+    std::atomic<int> timerLevel{initialTimerLevel()};
+    std::atomic<bool> timerSummaryEnabled{initialSummaryEnabled()};
+
+    void AddTimerCall(const char* name, std::int64_t nanoseconds) noexcept {
+      auto table = localTable;
+      if(!table)
+        table = localTable = registerTable();
+      auto& entry = (*table)[name];
+      entry.calls++;
+      entry.nanoseconds += nanoseconds;
+    }
+  }
+
+  int GetTimerLevel() noexcept {
+    return detail::timerLevel.load(std::memory_order_relaxed);
+  }
+
+  void SetTimerLevel(int level) noexcept {
+    detail::timerLevel.store(std::clamp(level, 0, REDEV_TIMER_LEVEL),
+        std::memory_order_relaxed);
+  }
+
+  void EnableTimerSummary(const std::string& path) {
+    auto& s = summaryState();
+    {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.path = path;
+    }
+    detail::timerSummaryEnabled.store(true, std::memory_order_relaxed);
+  }
+
+  void DisableTimerSummary() noexcept {
+    detail::timerSummaryEnabled.store(false, std::memory_order_relaxed);
+  }
+
+  std::vector<TimerSummary> SummarizeTimers(MPI_Comm comm) {
+    int rank, commSize;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &commSize);
+    //merge the threads, the same name may have several addresses
+    std::map<std::string, TimerCalls> local;
+    {
+      auto& s = summaryState();
+      std::lock_guard<std::mutex> lock(s.mutex);
+      for(auto& table : s.tables) {
+        for(const auto& [name, calls] : *table) {
+          auto& entry = local[name];
+          entry.calls += calls.calls;
+          entry.nanoseconds += calls.nanoseconds;
+        }
+        table->clear();
+      }
+    }
+    //the union of the names of all ranks, in the same order on every rank
+    const auto names = joinNames(local);
+    int len = static_cast<int>(names.size());
+    std::vector<int> lens(commSize);
+    MPI_Allgather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, comm);
+    std::vector<int> displs(commSize, 0);
+    for(int i=1; i<commSize; i++)
+      displs[i] = displs[i-1] + lens[i-1];
+    std::string all(displs.back() + lens.back(), '\0');
+    MPI_Allgatherv(names.data(), len, MPI_CHAR, all.data(), lens.data(),
+        displs.data(), MPI_CHAR, comm);
+    std::map<std::string, std::size_t> index;
+    for(std::size_t first=0; first<all.size(); ) {
+      const auto last = all.find('\0', first);
+      index.emplace(all.substr(first, last-first), 0);
+      first = last+1;
+    }
+    std::size_t n = 0;
+    for(auto& [name, i] : index)
+      i = n++;
+
+    std::vector<long long> calls(n, 0);
+    std::vector<double> seconds(n, 0);
+    for(const auto& [name, c] : local) {
+      calls[index[name]] = c.calls;
+      seconds[index[name]] = c.nanoseconds*1e-9;
+    }
+    std::vector<long long> sumCalls(n);
+    std::vector<double> minSeconds(n), sumSeconds(n);
+    std::vector<DoubleInt> maxSeconds(n), in(n);
+    for(std::size_t i=0; i<n; i++)
+      in[i] = {seconds[i], rank};
+    MPI_Allreduce(calls.data(), sumCalls.data(), n, MPI_LONG_LONG, MPI_SUM, comm);
+    MPI_Allreduce(seconds.data(), minSeconds.data(), n, MPI_DOUBLE, MPI_MIN, comm);
+    MPI_Allreduce(seconds.data(), sumSeconds.data(), n, MPI_DOUBLE, MPI_SUM, comm);
+    MPI_Allreduce(in.data(), maxSeconds.data(), n, MPI_DOUBLE_INT, MPI_MAXLOC, comm);
+
+    std::vector<TimerSummary> summary;
+    summary.reserve(n);
+    for(const auto& [name, i] : index) {
+      summary.push_back({name, sumCalls[i], minSeconds[i], sumSeconds[i]/commSize,
+          maxSeconds[i].value, maxSeconds[i].rank});
+    }
+    std::sort(summary.begin(), summary.end(),
+        [](const TimerSummary& a, const TimerSummary& b) {
+          return a.maxSeconds > b.maxSeconds;
+        });
+    return summary;
+  }
+
+  void WriteTimerSummary(MPI_Comm comm) {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if(!TimerSummaryEnabled() || comm == MPI_COMM_NULL || finalized)
+      return;
+    const auto summary = SummarizeTimers(comm);
+    int rank, commSize;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &commSize);
+    if(rank)
+      return;
+    std::string path;
+    {
+      auto& s = summaryState();
+      std::lock_guard<std::mutex> lock(s.mutex);
+      path = s.path;
+    }
+    std::ofstream file;
+    if(!path.empty()) {
+      file.open(path);
+      REDEV_ALWAYS_ASSERT(file.is_open());
+    }
+    std::ostream& os = path.empty() ? std::cout : file;
+    os << "redev timer summary over " << commSize << " ranks, inclusive seconds\n"
+       << std::setw(12) << "calls" << std::setw(12) << "min"
+       << std::setw(12) << "avg" << std::setw(12) << "max"
+       << std::setw(8) << "rank" << "  name\n";
+    os << std::scientific << std::setprecision(3);
+    for(const auto& t : summary) {
+      os << std::setw(12) << t.calls << std::setw(12) << t.minSeconds
+         << std::setw(12) << t.avgSeconds << std::setw(12) << t.maxSeconds
+         << std::setw(8) << t.maxRank << "  " << t.name << "\n";
+    }
+    os.flush();
+  }
+
+}
@@ -1,9 +1,169 @@
 #ifndef REDEV_PROFILE_H
 #define REDEV_PROFILE_H
 #include <perfstubs_api/timer.h>
+#include <mpi.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
 
+/**
+ * The timers are grouped in levels by cost:
+ *   1 phases, e.g., channel setup and partition construction
+ *   2 calls, e.g., Send, Recv, and the communication phases
+ *   3 hot paths, e.g., the per point and per entity GetRank functions
+ * Timers above REDEV_TIMER_LEVEL, set by the CMake option of the same name,
+ * compile to nothing. The remaining timers can be turned off at runtime with
+ * the REDEV_TIMER_LEVEL environment variable or redev::SetTimerLevel.
+ *
+ * Besides starting perfstubs timers, which record nothing unless a tool like
+ * TAU is loaded, the timers can count calls and inclusive time in thread
+ * local tables. This built-in summary is enabled by the REDEV_TIMER_SUMMARY
+ * environment variable, set to 1 to print on rank 0 or to a file name, or by
+ * redev::EnableTimerSummary. Redev::Finalize, or the Redev destructor if it
+ * was not called, reduces the tables across its ranks and rank 0 writes the
+ * min/avg/max time of each timer.
+ */
+#ifndef REDEV_TIMER_LEVEL
+#define REDEV_TIMER_LEVEL 2
+#endif
+
+#if defined(__GNUC__)
+#define REDEV_FUNCTION_NAME __PRETTY_FUNCTION__
+#else
+#define REDEV_FUNCTION_NAME __func__
+#endif
+
+namespace redev {
+
+namespace detail {
+extern std::atomic<int> timerLevel;
+extern std::atomic<bool> timerSummaryEnabled;
+/**
+ * Add one call of the named timer to the table of the calling thread.
+ */
+void AddTimerCall(const char *name, std::int64_t nanoseconds) noexcept;
+[[nodiscard]] inline std::int64_t timerNow() noexcept {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+} // namespace detail
+
+/**
+ * Return the runtime timer level, at most REDEV_TIMER_LEVEL.
+ */
+[[nodiscard]] int GetTimerLevel() noexcept;
+/**
+ * Set the runtime timer level. Timers with a level above it do not start.
+ * @param[in] level 0 disables all timers, values above REDEV_TIMER_LEVEL are
+ * reduced to it
+ */
+void SetTimerLevel(int level) noexcept;
+
+/**
+ * Enable the built-in timer summary.
+ * @param[in] path file rank 0 writes the summary to, empty for stdout
+ */
+void EnableTimerSummary(const std::string &path = "");
+/**
+ * Disable the built-in timer summary. The tables keep their entries until the
+ * next call to SummarizeTimers.
+ */
+void DisableTimerSummary() noexcept;
+[[nodiscard]] inline bool TimerSummaryEnabled() noexcept {
+  return detail::timerSummaryEnabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * The calls and inclusive time of one timer across the ranks of a
+ * communicator.
+ */
+struct TimerSummary {
+  std::string name;
+  /// calls summed over the ranks
+  long long calls = 0;
+  /// min/avg/max over the ranks of the time of each rank in seconds
+  double minSeconds = 0;
+  double avgSeconds = 0;
+  double maxSeconds = 0;
+  int maxRank = 0;
+};
+
+/**
+ * Reduce the timer tables of all threads and ranks in comm and clear them.
+ * Collective on comm. Must not be called while other threads run timers.
+ * @return the summary of each timer that ran on any rank sorted by maxSeconds,
+ * largest first
+ */
+[[nodiscard]] std::vector<TimerSummary> SummarizeTimers(MPI_Comm comm);
+
+/**
+ * Call SummarizeTimers and write the result on rank 0 to the path given to
+ * EnableTimerSummary or REDEV_TIMER_SUMMARY. Does nothing if the summary is
+ * not enabled; otherwise collective on comm. Called by Redev::Finalize.
+ */
+void WriteTimerSummary(MPI_Comm comm);
 
-#define REDEV_FUNCTION_TIMER \
-  PERFSTUBS_SCOPED_TIMER_FUNC()
+/**
+ * Start a perfstubs timer on construction and stop it on destruction if its
+ * level is enabled at runtime. The name must be a string with static storage
+ * duration; unlike PERFSTUBS_SCOPED_TIMER_FUNC no string is built per call.
+ */
+class ScopedTimer {
+public:
+  ScopedTimer(const char *name_, int level) noexcept
+      : name(level <= detail::timerLevel.load(std::memory_order_relaxed)
+                 ? name_
+                 : nullptr) {
+    if (name) {
+      PERFSTUBS_START_STRING(name);
+      if (TimerSummaryEnabled())
+        start = detail::timerNow();
+    }
+  }
+  ScopedTimer(const ScopedTimer &) = delete;
+  ScopedTimer &operator=(const ScopedTimer &) = delete;
+  ~ScopedTimer() {
+    if (name) {
+      PERFSTUBS_STOP_STRING(name);
+      if (start >= 0)
+        detail::AddTimerCall(name, detail::timerNow() - start);
+    }
+  }
+
+private:
+  const char *name;
+  std::int64_t start = -1;
+};
+
+} // namespace redev
+
+#define REDEV_TIMER_CONCAT_IMPL(a, b) a##b
+#define REDEV_TIMER_CONCAT(a, b) REDEV_TIMER_CONCAT_IMPL(a, b)
+#define REDEV_SCOPED_TIMER(name, level)                                        \
+  redev::ScopedTimer REDEV_TIMER_CONCAT(redevScopedTimer, __LINE__)(name, level)
+
+#if REDEV_TIMER_LEVEL >= 1
+/// time a coarse region, name is a string literal
+#define REDEV_PHASE_TIMER(name) REDEV_SCOPED_TIMER(name, 1)
+#else
+#define REDEV_PHASE_TIMER(name) static_cast<void>(0)
+#endif
+
+#if REDEV_TIMER_LEVEL >= 2
+/// time the enclosing function
+#define REDEV_FUNCTION_TIMER REDEV_SCOPED_TIMER(REDEV_FUNCTION_NAME, 2)
+#else
+#define REDEV_FUNCTION_TIMER static_cast<void>(0)
+#endif
+
+#if REDEV_TIMER_LEVEL >= 3
+/// time the enclosing function, for functions called per point or entity
+#define REDEV_HOT_TIMER REDEV_SCOPED_TIMER(REDEV_FUNCTION_NAME, 3)
+#else
+#define REDEV_HOT_TIMER static_cast<void>(0)
+#endif
 
 #endif
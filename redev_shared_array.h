@@ -0,0 +1,188 @@
+#ifndef REDEV_REDEV_SHARED_ARRAY_H
+#define REDEV_REDEV_SHARED_ARRAY_H
+#include "redev_assert.h"
+#include "redev_profile.h"
+#include "redev_types.h"
+#include <mpi.h>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace redev {
+
+namespace detail {
+/**
+ * Owner of an MPI shared memory window. Freeing the window is collective over
+ * the ranks of the node that allocated it.
+ */
+class SharedWindow {
+public:
+  SharedWindow() = default;
+  SharedWindow(const SharedWindow &) = delete;
+  SharedWindow &operator=(const SharedWindow &) = delete;
+  ~SharedWindow() {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (win != MPI_WIN_NULL && !finalized) {
+      MPI_Win_free(&win);
+    }
+  }
+  MPI_Win win = MPI_WIN_NULL;
+};
+
+/**
+ * Broadcast count values of type T from root as bytes, in pieces that fit
+ * the int count of MPI_Bcast.
+ */
+template <typename T>
+void BroadcastValues(T *values, long long count, int root, MPI_Comm comm) {
+  auto bytes = reinterpret_cast<char *>(values);
+  const long long total = count * static_cast<long long>(sizeof(T));
+  for (long long first = 0; first < total; first += INT_MAX) {
+    const auto piece =
+        static_cast<int>(std::min<long long>(INT_MAX, total - first));
+    MPI_Bcast(bytes + first, piece, MPI_BYTE, root, comm);
+  }
+}
+} // namespace detail
+
+/**
+ * The SharedArray class stores the flat arrays of a partition either in a
+ * std::vector owned by each rank, the default, or in an MPI shared memory
+ * window that all ranks of a node map read-only. Copies of a node shared
+ * array refer to the same window.
+ */
+template <typename T> class SharedArray {
+public:
+  SharedArray() = default;
+  SharedArray(std::vector<T> values) : vec(std::move(values)) {}
+  [[nodiscard]] const T *data() const noexcept {
+    return window ? shared : vec.data();
+  }
+  [[nodiscard]] std::size_t size() const noexcept {
+    return window ? count : vec.size();
+  }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+  [[nodiscard]] const T &operator[](std::size_t i) const noexcept {
+    return data()[i];
+  }
+  [[nodiscard]] const T *begin() const noexcept { return data(); }
+  [[nodiscard]] const T *end() const noexcept { return data() + size(); }
+  /**
+   * Return true if the values are stored in a node shared window.
+   */
+  [[nodiscard]] bool IsNodeShared() const noexcept { return bool(window); }
+  /**
+   * Return a copy of the values.
+   */
+  [[nodiscard]] std::vector<T> ToVector() const {
+    return std::vector<T>(begin(), end());
+  }
+  /**
+   * Return the vector for modification. The values are first copied out of
+   * the node shared window, if there is one.
+   */
+  std::vector<T> &Vector() {
+    if (window) {
+      vec = ToVector();
+      window.reset();
+      shared = nullptr;
+      count = 0;
+    }
+    return vec;
+  }
+  /**
+   * Send the values on root to all other ranks in comm, each rank stores a
+   * copy.
+   * Collective on comm.
+   */
+  void Broadcast(MPI_Comm comm, int root = 0) {
+    REDEV_FUNCTION_TIMER;
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    auto &values = Vector();
+    int len = static_cast<int>(values.size());
+    MPI_Bcast(&len, 1, MPI_INT, root, comm);
+    if (root != rank)
+      values.resize(len);
+    detail::BroadcastValues(values.data(), len, root, comm);
+  }
+  /**
+   * Send the values on root to one rank per node, the node leader, which
+   * stores them in an MPI shared memory window. The other ranks of the node
+   * map the leader's copy and keep no copy of their own.
+   * Collective on comm. The window is freed when the last copy of this
+   * array on a rank is destroyed, which is collective over the ranks of the
+   * node.
+   */
+  void BroadcastNodeShared(MPI_Comm comm, int root = 0) {
+    REDEV_FUNCTION_TIMER;
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    Assign(comm, root, rank == root ? ToVector() : std::vector<T>());
+  }
+  /**
+   * Replace the values by the ones passed on root and store them as
+   * BroadcastNodeShared does; the values passed on the other ranks are
+   * ignored. Unlike modifying Vector() on root, the previous window is kept
+   * until all ranks installed the new one and then released on all of them,
+   * so root can read the new values while the others wait in this call.
+   * Collective on comm.
+   */
+  void Assign(MPI_Comm comm, int root, std::vector<T> values) {
+    REDEV_FUNCTION_TIMER;
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+    // root is given the lowest key so that it leads its node and the leaders
+    const int key = (rank == root) ? -1 : rank;
+    MPI_Comm node;
+    MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, key, MPI_INFO_NULL,
+                        &node);
+    int nodeRank;
+    MPI_Comm_rank(node, &nodeRank);
+    MPI_Comm leaders;
+    MPI_Comm_split(comm, nodeRank == 0 ? 0 : MPI_UNDEFINED, key, &leaders);
+
+    long long len = static_cast<long long>(values.size());
+    if (leaders != MPI_COMM_NULL)
+      MPI_Bcast(&len, 1, MPI_LONG_LONG, 0, leaders);
+    MPI_Bcast(&len, 1, MPI_LONG_LONG, 0, node);
+
+    auto newWindow = std::make_shared<detail::SharedWindow>();
+    const MPI_Aint bytes = nodeRank == 0 ? len * sizeof(T) : 0;
+    void *base = nullptr;
+    MPI_Win_allocate_shared(bytes, sizeof(T), MPI_INFO_NULL, node, &base,
+                            &newWindow->win);
+    MPI_Aint leaderBytes;
+    int dispUnit;
+    MPI_Win_shared_query(newWindow->win, 0, &leaderBytes, &dispUnit, &base);
+    auto values_ = static_cast<T *>(base);
+    if (leaders != MPI_COMM_NULL) {
+      if (rank == root && len)
+        std::memcpy(values_, values.data(), len * sizeof(T));
+      detail::BroadcastValues(values_, len, 0, leaders);
+      MPI_Comm_free(&leaders);
+    }
+    // the leader's writes are complete before any rank of the node reads
+    MPI_Win_fence(0, newWindow->win);
+    MPI_Comm_free(&node);
+
+    vec.clear();
+    vec.shrink_to_fit();
+    window = std::move(newWindow);
+    shared = values_;
+    count = static_cast<std::size_t>(len);
+  }
+
+private:
+  std::vector<T> vec;
+  std::shared_ptr<detail::SharedWindow> window;
+  const T *shared = nullptr;
+  std::size_t count = 0;
+};
+
+} // namespace redev
+
+#endif // REDEV_REDEV_SHARED_ARRAY_H
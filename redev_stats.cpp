@@ -0,0 +1,151 @@
+#include "redev_stats.h"
+#include "redev_assert.h"
+#include "redev_profile.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+  //elementwise sum of two vectors that may have different lengths
+  void addTo(redev::GOs& sum, const redev::GOs& values) {
+    if(sum.size() < values.size())
+      sum.resize(values.size(), 0);
+    for(size_t i=0; i<values.size(); i++)
+      sum[i] += values[i];
+  }
+
+  redev::StatSummary summarize(double value, MPI_Comm comm) {
+    int rank, commSize;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &commSize);
+    struct { double value; int rank; } in{value, rank}, lo, hi;
+    MPI_Allreduce(&in, &lo, 1, MPI_DOUBLE_INT, MPI_MINLOC, comm);
+    MPI_Allreduce(&in, &hi, 1, MPI_DOUBLE_INT, MPI_MAXLOC, comm);
+    double sum = 0;
+    MPI_Allreduce(&value, &sum, 1, MPI_DOUBLE, MPI_SUM, comm);
+    return {lo.value, hi.value, sum/commSize, lo.rank, hi.rank};
+  }
+
+  redev::LatencyHistogram sumHistogram(const redev::LatencyHistogram& h, MPI_Comm comm) {
+    std::array<redev::GO, redev::LatencyHistogram::numBins> sum{};
+    MPI_Allreduce(h.GetCounts().data(), sum.data(), sum.size(), MPI_INT64_T, MPI_SUM, comm);
+    return redev::LatencyHistogram(sum);
+  }
+
+  void printSummary(std::ostream& os, const char* name, const redev::StatSummary& s) {
+    os << "  " << name << " min " << s.min << " (rank " << s.minRank << ")"
+       << " max " << s.max << " (rank " << s.maxRank << ")"
+       << " avg " << s.avg << "\n";
+  }
+
+  void printHistogram(std::ostream& os, const char* name, const redev::LatencyHistogram& h) {
+    if(!h.Count()) return;
+    os << "  " << name << " count " << h.Count()
+       << " p50 <= " << h.Quantile(0.5) << " s"
+       << " p99 <= " << h.Quantile(0.99) << " s\n";
+  }
+}
+
+namespace redev {
+
+  void LatencyHistogram::Add(double seconds) noexcept {
+    const auto us = static_cast<std::uint64_t>(seconds*1e6);
+    int bin = 0;
+    if(us) {
+      //index of the highest set bit
+      bin = 63 - __builtin_clzll(us);
+    }
+    counts[std::min(bin, numBins-1)]++;
+  }
+
+  void LatencyHistogram::Merge(const LatencyHistogram& other) noexcept {
+    for(int i=0; i<numBins; i++)
+      counts[i] += other.counts[i];
+  }
+
+  void LatencyHistogram::Reset() noexcept {
+    counts.fill(0);
+  }
+
+  redev::GO LatencyHistogram::Count() const noexcept {
+    return std::accumulate(counts.begin(), counts.end(), redev::GO(0));
+  }
+
+  double LatencyHistogram::Quantile(double q) const noexcept {
+    const auto total = Count();
+    if(!total) return 0;
+    const auto target = static_cast<redev::GO>(std::ceil(q*total));
+    redev::GO seen = 0;
+    for(int i=0; i<numBins; i++) {
+      seen += counts[i];
+      if(seen >= target && seen)
+        return std::ldexp(1.0, i+1)*1e-6;
+    }
+    return std::ldexp(1.0, numBins)*1e-6;
+  }
+
+  void CommStats::Merge(const CommStats& other) {
+    steps += other.steps;
+    sends += other.sends;
+    recvs += other.recvs;
+    messagesSent += other.messagesSent;
+    messagesReceived += other.messagesReceived;
+    bytesSent += other.bytesSent;
+    bytesReceived += other.bytesReceived;
+    addTo(bytesSentPerDest, other.bytesSentPerDest);
+    addTo(bytesReceivedPerSrc, other.bytesReceivedPerSrc);
+    metadataSeconds += other.metadataSeconds;
+    transferSeconds += other.transferSeconds;
+    stepSeconds += other.stepSeconds;
+    sendLatency.Merge(other.sendLatency);
+    recvLatency.Merge(other.recvLatency);
+    stepLatency.Merge(other.stepLatency);
+  }
+
+  void CommStats::Reset() {
+    *this = CommStats{};
+  }
+
+  CommStatsReport Report(const CommStats& stats, MPI_Comm comm, int numSlowest) {
+    REDEV_FUNCTION_TIMER;
+    REDEV_ALWAYS_ASSERT(comm != MPI_COMM_NULL);
+    REDEV_ALWAYS_ASSERT(numSlowest >= 0);
+    CommStatsReport report;
+    MPI_Comm_size(comm, &report.commSize);
+    report.bytesSent = summarize(static_cast<double>(stats.bytesSent), comm);
+    report.bytesReceived = summarize(static_cast<double>(stats.bytesReceived), comm);
+    report.metadataSeconds = summarize(stats.metadataSeconds, comm);
+    report.transferSeconds = summarize(stats.transferSeconds, comm);
+    report.stepSeconds = summarize(stats.stepSeconds, comm);
+    report.sendLatency = sumHistogram(stats.sendLatency, comm);
+    report.recvLatency = sumHistogram(stats.recvLatency, comm);
+    report.stepLatency = sumHistogram(stats.stepLatency, comm);
+    const double total = stats.metadataSeconds + stats.transferSeconds + stats.stepSeconds;
+    std::vector<double> totals(report.commSize);
+    MPI_Allgather(&total, 1, MPI_DOUBLE, totals.data(), 1, MPI_DOUBLE, comm);
+    std::vector<int> order(report.commSize);
+    std::iota(order.begin(), order.end(), 0);
+    const auto n = std::min(numSlowest, report.commSize);
+    std::partial_sort(order.begin(), order.begin()+n, order.end(),
+        [&](int a, int b) { return totals[a] > totals[b]; });
+    report.slowestRanks.assign(order.begin(), order.begin()+n);
+    return report;
+  }
+
+  std::ostream& operator<<(std::ostream& os, const CommStatsReport& report) {
+    os << "redev communication statistics over " << report.commSize << " ranks\n";
+    printSummary(os, "bytes sent", report.bytesSent);
+    printSummary(os, "bytes received", report.bytesReceived);
+    printSummary(os, "metadata (s)", report.metadataSeconds);
+    printSummary(os, "put/get (s)", report.transferSeconds);
+    printSummary(os, "begin/end step (s)", report.stepSeconds);
+    printHistogram(os, "send latency", report.sendLatency);
+    printHistogram(os, "recv latency", report.recvLatency);
+    printHistogram(os, "step latency", report.stepLatency);
+    os << "  slowest ranks";
+    for(auto r : report.slowestRanks) os << " " << r;
+    os << "\n";
+    return os;
+  }
+
+}
@@ -0,0 +1,174 @@
+#ifndef REDEV_REDEV_STATS_H
+#define REDEV_REDEV_STATS_H
+#include "redev_types.h"
+#include <mpi.h>
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+namespace redev {
+
+/**
+ * The LatencyHistogram class counts durations in power of two bins. Bin i
+ * counts the durations in [2^i, 2^(i+1)) microseconds; bin 0 also counts the
+ * shorter durations and the last bin the longer ones. Adding a duration costs
+ * a few integer operations so it can be left enabled in production runs.
+ */
+class LatencyHistogram {
+public:
+  static constexpr int numBins = 32;
+  LatencyHistogram() = default;
+  explicit LatencyHistogram(const std::array<redev::GO, numBins> &counts_)
+      : counts(counts_) {}
+  /**
+   * Count a duration.
+   * @param[in] seconds the duration in seconds
+   */
+  void Add(double seconds) noexcept;
+  /**
+   * Add the counts of another histogram to this one.
+   */
+  void Merge(const LatencyHistogram &other) noexcept;
+  void Reset() noexcept;
+  /**
+   * Return the number of durations counted.
+   */
+  [[nodiscard]] redev::GO Count() const noexcept;
+  /**
+   * Return the upper bound, in seconds, of the bin containing the given
+   * quantile of the durations.
+   * @param[in] q the quantile in [0:1], e.g., 0.5 for the median
+   */
+  [[nodiscard]] double Quantile(double q) const noexcept;
+  [[nodiscard]] const std::array<redev::GO, numBins> &GetCounts() const noexcept {
+    return counts;
+  }
+
+private:
+  std::array<redev::GO, numBins> counts{};
+};
+
+/**
+ * The CommStats struct contains the communication counters and timers of one
+ * rank. AdiosComm records the messages it sends and receives, and the time
+ * split into metadata collectives and exchanges, Put/Get calls, and the
+ * engine step calls. AdiosChannel records the steps.
+ */
+struct CommStats {
+  /// number of communication phases (steps)
+  redev::GO steps = 0;
+  /// number of calls to Send
+  redev::GO sends = 0;
+  /// number of calls to Recv
+  redev::GO recvs = 0;
+  /// number of non-empty messages sent, one per destination per Send
+  redev::GO messagesSent = 0;
+  /// number of non-empty messages received, one per source per Recv
+  redev::GO messagesReceived = 0;
+  redev::GO bytesSent = 0;
+  redev::GO bytesReceived = 0;
+  /// bytes sent to each rank of the receiving application
+  redev::GOs bytesSentPerDest;
+  /// bytes received from each rank of the sending application
+  redev::GOs bytesReceivedPerSrc;
+  /// time in the collectives and metadata reads that set up the messages
+  double metadataSeconds = 0;
+  /// time in ADIOS2 Put/Get and PerformPuts/PerformGets
+  double transferSeconds = 0;
+  /// time in ADIOS2 BeginStep/EndStep, mostly waiting for the other
+  /// application
+  double stepSeconds = 0;
+  /// duration of each Send
+  LatencyHistogram sendLatency;
+  /// duration of each Recv
+  LatencyHistogram recvLatency;
+  /// duration of each BeginStep
+  LatencyHistogram stepLatency;
+  /**
+   * Add the counters and timers of another object to this one.
+   */
+  void Merge(const CommStats &other);
+  void Reset();
+};
+
+/**
+ * The minimum, maximum, and average of a quantity across the ranks of a
+ * communicator and the ranks holding the extrema.
+ */
+struct StatSummary {
+  double min = 0;
+  double max = 0;
+  double avg = 0;
+  int minRank = 0;
+  int maxRank = 0;
+};
+
+/**
+ * The CommStatsReport struct summarizes the CommStats of all ranks in a
+ * communicator. Compare stepSeconds with transferSeconds to tell waiting for
+ * the other application apart from bandwidth limits, and max with avg to
+ * find the imbalance across ranks.
+ */
+struct CommStatsReport {
+  int commSize = 0;
+  StatSummary bytesSent;
+  StatSummary bytesReceived;
+  StatSummary metadataSeconds;
+  StatSummary transferSeconds;
+  StatSummary stepSeconds;
+  /// histograms summed over the ranks
+  LatencyHistogram sendLatency;
+  LatencyHistogram recvLatency;
+  LatencyHistogram stepLatency;
+  /// ranks with the largest metadata+transfer+step time, slowest first
+  std::vector<int> slowestRanks;
+};
+
+/**
+ * Summarize the statistics of all ranks in comm. Collective on comm.
+ * @param[in] stats the statistics of this rank
+ * @param[in] comm the ranks to summarize
+ * @param[in] numSlowest the number of slowest ranks to report, at least 0
+ */
+[[nodiscard]] CommStatsReport Report(const CommStats &stats, MPI_Comm comm,
+                                     int numSlowest = 4);
+
+std::ostream &operator<<(std::ostream &os, const CommStatsReport &report);
+
+/**
+ * Add the time since construction to a counter, a histogram, or both, when
+ * the object goes out of scope.
+ */
+class StatsTimer {
+public:
+  explicit StatsTimer(double &seconds_, LatencyHistogram *histogram_ = nullptr)
+      : seconds(&seconds_), histogram(histogram_),
+        start(std::chrono::steady_clock::now()) {}
+  /**
+   * Only count the duration in the histogram, e.g., for calls whose time is
+   * already split into other counters.
+   */
+  explicit StatsTimer(LatencyHistogram &histogram_)
+      : seconds(nullptr), histogram(&histogram_),
+        start(std::chrono::steady_clock::now()) {}
+  StatsTimer(const StatsTimer &) = delete;
+  StatsTimer &operator=(const StatsTimer &) = delete;
+  ~StatsTimer() {
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    if (seconds)
+      *seconds += elapsed.count();
+    if (histogram)
+      histogram->Add(elapsed.count());
+  }
+
+private:
+  double *seconds;
+  LatencyHistogram *histogram;
+  std::chrono::steady_clock::time_point start;
+};
+
+} // namespace redev
+
+#endif // REDEV_REDEV_STATS_H
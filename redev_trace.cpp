@@ -0,0 +1,243 @@
+#include "redev_trace.h"
+#include "redev_assert.h"
+#include "redev.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+  struct Event {
+    const char* name;
+    std::int64_t begin;
+    std::int64_t end;
+  };
+
+  //ring buffer written only by its thread and read by Flush after tracing is
+  //disabled
+  struct Buffer {
+    std::vector<Event> events;
+    std::size_t next = 0;
+    std::uint64_t recorded = 0;
+    int tid = 0;
+  };
+
+  struct ClockOffset {
+    std::string channel;
+    std::int64_t offset;
+    std::int64_t delay;
+  };
+
+  struct State {
+    std::mutex mutex; //protects buffers and offsets
+    std::vector<std::unique_ptr<Buffer>> buffers;
+    std::vector<ClockOffset> offsets;
+    std::string prefix;
+    std::size_t capacity = 0;
+    std::int64_t steadyEpoch = 0;
+    std::int64_t wallEpoch = 0;
+  };
+
+  State& state() {
+    static State s;
+    return s;
+  }
+
+  //buffers are never freed so the pointer stays valid after Flush
+  thread_local Buffer* localBuffer = nullptr;
+
+  Buffer* registerBuffer() {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto buf = std::make_unique<Buffer>();
+    buf->events.resize(s.capacity);
+    buf->tid = static_cast<int>(s.buffers.size());
+    s.buffers.push_back(std::move(buf));
+    return s.buffers.back().get();
+  }
+
+  std::int64_t toNanoseconds(redev::TimeType t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        t.time_since_epoch()).count();
+  }
+
+  //print the times in microseconds with nanosecond digits, a double does not
+  //have enough digits for wall clock nanoseconds
+  void appendEvent(std::string& out, const char* name, int pid, int tid,
+      std::int64_t ts, std::int64_t dur) {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,"
+        "\"ts\":%lld.%03lld,\"dur\":%lld.%03lld}",
+        name, pid, tid, static_cast<long long>(ts/1000),
+        static_cast<long long>(ts%1000), static_cast<long long>(dur/1000),
+        static_cast<long long>(dur%1000));
+    out += buf;
+  }
+
+  //events of this rank, the string starts with the process metadata events
+  std::string serialize(int rank, bool isServer, std::int64_t shift) {
+    auto& s = state();
+    const int pid = isServer ? rank : (1 << 20) + rank;
+    std::uint64_t dropped = 0;
+    for(const auto& buf : s.buffers)
+      if(buf->recorded > buf->events.size())
+        dropped += buf->recorded - buf->events.size();
+    char buf[256];
+    std::snprintf(buf, sizeof(buf),
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,"
+        "\"args\":{\"name\":\"redev %s rank %d\",\"dropped events\":%llu}},\n"
+        "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"sort_index\":%d}}",
+        pid, isServer ? "server" : "client", rank,
+        static_cast<unsigned long long>(dropped), pid, pid);
+    std::string out(buf);
+    const auto toWall = s.wallEpoch - s.steadyEpoch + shift;
+    for(const auto& b : s.buffers) {
+      const auto n = std::min<std::uint64_t>(b->recorded, b->events.size());
+      //oldest first
+      const auto first = (b->recorded > b->events.size()) ? b->next : 0;
+      for(std::size_t i=0; i<n; i++) {
+        const auto& e = b->events[(first+i)%b->events.size()];
+        appendEvent(out, e.name, pid, b->tid, e.begin+toWall, e.end-e.begin);
+      }
+    }
+    return out;
+  }
+}
+
+namespace redev {
+namespace trace {
+
+  std::atomic<bool> enabled{false};
+
+  void InitializeFromEnvironment() {
+    const char* prefix = std::getenv("REDEV_TRACE");
+    if(!prefix || !*prefix || std::string(prefix) == "0")
+      return;
+    std::size_t capacity = 1 << 16;
+    if(const char* size = std::getenv("REDEV_TRACE_BUFFER_SIZE"))
+      capacity = std::stoul(size);
+    Enable(std::string(prefix) == "1" ? "redev_trace" : prefix, capacity);
+  }
+
+  void Enable(const std::string& prefix, std::size_t capacity) {
+    REDEV_ALWAYS_ASSERT(capacity > 0);
+    auto& s = state();
+    {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.prefix = prefix;
+      if(s.buffers.empty()) {
+        s.capacity = capacity;
+        s.steadyEpoch = Now();
+        s.wallEpoch = WallNow();
+      }
+    }
+    enabled.store(true, std::memory_order_relaxed);
+  }
+
+  std::int64_t Now() noexcept {
+    return toNanoseconds(std::chrono::steady_clock::now());
+  }
+
+  std::int64_t WallNow() noexcept {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+
+  void Record(const char* name, std::int64_t begin, std::int64_t end) noexcept {
+    if(!Enabled())
+      return;
+    auto buf = localBuffer;
+    if(!buf)
+      buf = localBuffer = registerBuffer();
+    buf->events[buf->next] = Event{name, begin, end};
+    buf->next = (buf->next+1 == buf->events.size()) ? 0 : buf->next+1;
+    buf->recorded++;
+  }
+
+  void Record(const char* name, TimeType begin, TimeType end) noexcept {
+    if(!Enabled())
+      return;
+    Record(name, toNanoseconds(begin), toNanoseconds(end));
+  }
+
+  void AddClockOffset(const std::string& channel, std::int64_t t0,
+      std::int64_t t1, std::int64_t t2, std::int64_t t3) {
+    auto& s = state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.offsets.push_back({channel, ((t1-t0)+(t2-t3))/2, (t3-t0)-(t2-t1)});
+  }
+
+  void Flush(MPI_Comm comm, bool isServer) {
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if(!Enabled() || comm == MPI_COMM_NULL || finalized)
+      return;
+    enabled.store(false, std::memory_order_relaxed);
+    auto& s = state();
+    int rank, commSize;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &commSize);
+    //align the clocks of the ranks to rank 0, accurate to the skew of the
+    //barrier exit
+    MPI_Barrier(comm);
+    const auto now = WallNow();
+    auto rootNow = now;
+    redev::Broadcast(&rootNow, 1, 0, comm);
+    //shift the server onto the clock of the first client if the estimated
+    //offset is larger than its error, half the round trip; otherwise the
+    //wall clocks are already synchronized
+    std::int64_t appOffset = 0;
+    if(isServer && !rank && !s.offsets.empty()) {
+      const auto& o = s.offsets.front();
+      if(std::llabs(o.offset) > o.delay/2)
+        appOffset = o.offset;
+    }
+    redev::Broadcast(&appOffset, 1, 0, comm);
+    const auto events = serialize(rank, isServer, appOffset - (now - rootNow));
+
+    int len = static_cast<int>(events.size());
+    std::vector<int> lens(rank ? 0 : commSize);
+    MPI_Gather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, 0, comm);
+    std::vector<int> displs(lens.size(), 0);
+    std::string all;
+    if(!rank) {
+      for(int i=1; i<commSize; i++)
+        displs[i] = displs[i-1] + lens[i-1];
+      all.resize(displs.back() + lens.back());
+    }
+    MPI_Gatherv(events.data(), len, MPI_CHAR, all.data(), lens.data(),
+        displs.data(), MPI_CHAR, 0, comm);
+    if(!rank) {
+      const auto path = s.prefix + (isServer ? "_server.json" : "_client.json");
+      std::ofstream out(path);
+      REDEV_ALWAYS_ASSERT(out.is_open());
+      out << "{\"traceEvents\":[\n";
+      for(int i=0; i<commSize; i++) {
+        if(i) out << ",\n";
+        out.write(all.data()+displs[i], lens[i]);
+      }
+      out << "\n],\n\"displayTimeUnit\":\"ns\",\n\"otherData\":{";
+      for(std::size_t i=0; i<s.offsets.size(); i++) {
+        const auto& o = s.offsets[i];
+        out << (i ? ",\n" : "\n")
+            << "\"clock offset to client of channel " << o.channel << " (us)\":"
+            << o.offset*1e-3 << ",\n"
+            << "\"clock offset round trip of channel " << o.channel << " (us)\":"
+            << o.delay*1e-3;
+      }
+      out << "}}\n";
+    }
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for(auto& buf : s.buffers) {
+      buf->next = 0;
+      buf->recorded = 0;
+    }
+    s.offsets.clear();
+  }
+
+}
+}
@@ -0,0 +1,126 @@
+#ifndef REDEV_REDEV_TRACE_H
+#define REDEV_REDEV_TRACE_H
+#include "redev_time.h"
+#include <mpi.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace redev {
+namespace trace {
+
+/**
+ * Tracing records the begin and end of the channel phases, the stages of
+ * AdiosComm Send and Recv, and the ADIOS2 engine calls of each rank. It is
+ * enabled by setting the REDEV_TRACE environment variable on all ranks to the
+ * prefix of the trace files, or to 1 for the prefix "redev_trace", before the
+ * Redev object is created. Each thread records into its own ring buffer of
+ * REDEV_TRACE_BUFFER_SIZE events, 65536 by default, that keeps the most recent
+ * events. Recording does not take a lock. When tracing is disabled an event
+ * costs one relaxed atomic load.
+ *
+ * Redev::Finalize, or the Redev destructor if it was not called, has rank 0 of
+ * each application write the events of all its ranks to <prefix>_server.json
+ * or <prefix>_client.json in the Chrome trace event format that
+ * chrome://tracing and https://ui.perfetto.dev load. Timestamps are wall clock
+ * microseconds. The ranks of an application are aligned to its rank 0 and the
+ * server estimates the offset of its clock to each client with an NTP style
+ * exchange during channel setup. If the estimated offset is larger than its
+ * error, half the round trip of the exchange, the server events are shifted
+ * onto the clock of the client of the first channel so that the two files can
+ * be loaded together.
+ */
+
+/// when true events are recorded, see Enabled()
+extern std::atomic<bool> enabled;
+
+/**
+ * Return true if tracing is enabled.
+ */
+[[nodiscard]] inline bool Enabled() noexcept {
+  return enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Enable tracing if the REDEV_TRACE environment variable is set. Called by
+ * the Redev constructor.
+ */
+void InitializeFromEnvironment();
+
+/**
+ * Enable tracing.
+ * @param[in] prefix the prefix of the trace files
+ * @param[in] capacity the number of events each thread keeps
+ */
+void Enable(const std::string &prefix, std::size_t capacity = 1 << 16);
+
+/**
+ * Return the steady clock time in nanoseconds used for the event timestamps.
+ */
+[[nodiscard]] std::int64_t Now() noexcept;
+
+/**
+ * Return the wall clock time in nanoseconds used to align the clocks of the
+ * ranks and applications.
+ */
+[[nodiscard]] std::int64_t WallNow() noexcept;
+
+/**
+ * Record an event on the calling thread. Does nothing if tracing is disabled.
+ * @param[in] name name of the event, it must outlive the call to Flush, e.g.,
+ * a string literal
+ * @param[in] begin start time from Now()
+ * @param[in] end end time from Now()
+ */
+void Record(const char *name, std::int64_t begin, std::int64_t end) noexcept;
+void Record(const char *name, TimeType begin, TimeType end) noexcept;
+
+/**
+ * Record the offset of the clock of a client relative to this process,
+ * estimated during setup of the channel with the given name.
+ * @param[in] channel the channel name
+ * @param[in] t0 server time the request was sent
+ * @param[in] t1 client time the request was received
+ * @param[in] t2 client time the reply was sent
+ * @param[in] t3 server time the reply was received
+ */
+void AddClockOffset(const std::string &channel, std::int64_t t0,
+                    std::int64_t t1, std::int64_t t2, std::int64_t t3);
+
+/**
+ * Write the events of all ranks in comm to the trace file and disable
+ * tracing. Collective on comm if tracing is enabled, otherwise it does
+ * nothing.
+ * @param[in] comm the ranks of the application
+ * @param[in] isServer true on the server ranks
+ */
+void Flush(MPI_Comm comm, bool isServer);
+
+/**
+ * Record an event from construction to destruction.
+ */
+class ScopedEvent {
+public:
+  explicit ScopedEvent(const char *name_) noexcept
+      : name(name_), begin(Enabled() ? Now() : -1) {}
+  ScopedEvent(const ScopedEvent &) = delete;
+  ScopedEvent &operator=(const ScopedEvent &) = delete;
+  ~ScopedEvent() {
+    if (begin >= 0)
+      Record(name, begin, Now());
+  }
+
+private:
+  const char *name;
+  std::int64_t begin;
+};
+
+} // namespace trace
+} // namespace redev
+
+#define REDEV_TRACE_CONCAT_IMPL(a, b) a##b
+#define REDEV_TRACE_CONCAT(a, b) REDEV_TRACE_CONCAT_IMPL(a, b)
+#define REDEV_TRACE_EVENT(name)                                                \
+  redev::trace::ScopedEvent REDEV_TRACE_CONCAT(redevTraceEvent, __LINE__)(name)
+
+#endif // REDEV_REDEV_TRACE_H
@@ -24,6 +24,11 @@ using CVs = std::vector<CV>;
 
 enum class ProcessType { Client = 0, Server = 1 };
 enum class TransportType { BP4 = 0, SST = 1 };
+/**
+ * Where each rank keeps the partition after it is received: a copy per rank,
+ * or one copy per node in an MPI shared memory window.
+ */
+enum class PartitionStorage { Replicated = 0, NodeShared = 1 };
 
 }
 #endif
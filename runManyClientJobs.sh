@@ -0,0 +1,47 @@
+#!/bin/bash
+# Launch one rendezvous server and N clients of util_benchManyClients at the
+# same time, for each N in a comma separated list, like runMultipleMpiJobs.sh
+# does for two or three applications. MPI launcher flags that must precede the
+# process count flag are read from the PREFLAGS environment variable.
+if [[ $# -lt 6 ]]; then
+  echo "Usage: <run command> <process flag> <serverProcs> <clientProcs> <numClients,...> <exe> [options]" && \
+  exit 1
+fi
+runCmd=${1}
+numProcsFlag=${2}
+serverProcs=${3}
+clientProcs=${4}
+IFS=',' read -a clientCounts <<< "${5}"
+exe=${6}
+shift 6
+
+run() {
+  local name=${1}
+  local procs=${2}
+  shift 2
+  ${runCmd} ${PREFLAGS} ${numProcsFlag} ${procs} ${exe} "$@" &> ${name}.log &
+  PIDS+=($!)
+  LOGS+=(${name}.log)
+}
+
+for numClients in "${clientCounts[@]}"; do
+  PIDS=()
+  LOGS=()
+  run server ${serverProcs} -1 ${serverProcs} ${numClients} "$@"
+  for (( i=0; i<numClients; i++ )); do
+    run client${i} ${clientProcs} ${i} ${serverProcs} ${numClients} "$@"
+  done
+  failed=0
+  for i in "${!PIDS[@]}"; do
+    wait ${PIDS[$i]}
+    status=$?
+    if [[ $status -ne 0 ]]; then
+      cat ${LOGS[$i]}
+      failed=$status
+    fi
+  done
+  [[ $failed -ne 0 ]] && exit $failed
+  #the next client count opens new engines with the same names
+  rm -rf client*_s2c.bp client*_c2s.bp
+done
+exit 0
@@ -0,0 +1,114 @@
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "redev.h"
+
+// One server and two clients, like test_twoClients, but the server begins
+// the receive phases with ChannelSet::WaitAny in the order the clients become
+// ready. In the first round client 1 delays its send so the server must
+// service client 0 first and a short WaitAny on client 1 alone times out.
+
+namespace {
+  const int rounds = 3;
+  const auto delay = std::chrono::seconds(2);
+}
+
+void client(redev::Redev& rdv, const int clientId, adios2::Params params, const bool isSST) {
+  const auto name = "client" + std::to_string(clientId);
+  auto channel = rdv.CreateAdiosChannel(name, params, static_cast<redev::TransportType>(isSST));
+  auto comm = channel.CreateComm<redev::LO>(name, rdv.GetMPIComm());
+  redev::LOs dest{0};
+  redev::LOs offsets{0,1};
+  comm.SetOutMessageLayout(dest, offsets);
+  for(int round=0; round<rounds; round++) {
+    if(round == 0 && clientId == 1)
+      std::this_thread::sleep_for(delay);
+    redev::LOs msgs(1, 42+clientId);
+    channel.SendPhase([&]() { comm.Send(msgs.data()); });
+    //poll the reply, the server may still be waiting for the other client
+    while(!channel.TryBeginReceiveCommunicationPhase(0.01f)) {}
+    auto reply = comm.Recv();
+    channel.EndReceiveCommunicationPhase();
+    REDEV_ALWAYS_ASSERT(reply.size() == 1);
+    REDEV_ALWAYS_ASSERT(reply[0] == 1337+clientId);
+  }
+}
+
+void server(redev::Redev& rdv, adios2::Params params, const bool isSST) {
+  std::vector<redev::Channel> channels;
+  std::vector<redev::BidirectionalComm<redev::LO>> comms;
+  for(int i=0; i<2; i++) {
+    const auto name = "client" + std::to_string(i);
+    channels.push_back(rdv.CreateAdiosChannel(name, params, static_cast<redev::TransportType>(isSST)));
+    comms.push_back(channels.back().CreateComm<redev::LO>(name, rdv.GetMPIComm()));
+  }
+  redev::ChannelSet set(rdv.GetMPIComm());
+  for(auto& channel : channels)
+    REDEV_ALWAYS_ASSERT(set.Add(channel) == static_cast<size_t>(&channel-channels.data()));
+  REDEV_ALWAYS_ASSERT(set.Size() == 2);
+  redev::LOs dest{0};
+  redev::LOs offsets{0,1};
+  for(auto& comm : comms)
+    comm.SetOutMessageLayout(dest, offsets);
+
+  for(int round=0; round<rounds; round++) {
+    std::vector<size_t> pending{0, 1};
+    std::vector<size_t> served;
+    while(!pending.empty()) {
+      const auto ready = set.WaitAny(pending);
+      REDEV_ALWAYS_ASSERT(ready.has_value());
+      const auto i = *ready;
+      REDEV_ALWAYS_ASSERT(set[i].InReceiveCommunicationPhase());
+      auto msgs = comms[i].Recv();
+      set[i].EndReceiveCommunicationPhase();
+      REDEV_ALWAYS_ASSERT(msgs.size() == 1);
+      REDEV_ALWAYS_ASSERT(msgs[0] == static_cast<redev::LO>(42+i));
+      //reply right away so the client does not wait for the other one
+      redev::LOs reply(1, static_cast<redev::LO>(1337+i));
+      channels[i].SendPhase([&]() { comms[i].Send(reply.data()); });
+      pending.erase(std::find(pending.begin(), pending.end(), i));
+      served.push_back(i);
+      if(round == 0 && i == 0) {
+        //client 1 is still sleeping
+        REDEV_ALWAYS_ASSERT(!set.WaitAny(pending, 0.1f).has_value());
+      }
+    }
+    if(round == 0)
+      REDEV_ALWAYS_ASSERT(served == std::vector<size_t>({0, 1}));
+    std::cout << "round " << round << " served " << served[0] << " " << served[1] << "\n";
+  }
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int nproc;
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  if(argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <enableSST=0|1> <clientId=-1|0|1>\n";
+    exit(EXIT_FAILURE);
+  }
+  const auto isSST = (atoi(argv[1]) == 1);
+  const auto clientId = atoi(argv[2]);
+  REDEV_ALWAYS_ASSERT(clientId >= -1 && clientId <= 1);
+  REDEV_ALWAYS_ASSERT(nproc == 1);
+  {
+    adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "6"}};
+    if(clientId != -1) {
+      redev::Redev rdv(MPI_COMM_WORLD, redev::ProcessType::Client);
+      client(rdv, clientId, params, isSST);
+    } else {
+      //dummy partition, the layouts are set without GetRank(...)
+      const auto dim = 1;
+      auto ranks = redev::LOs({0});
+      auto cuts = redev::Reals({0});
+      auto ptn = redev::RCBPtn(dim, ranks, cuts);
+      redev::Redev rdv(MPI_COMM_WORLD, redev::Partition{std::move(ptn)},
+          redev::ProcessType::Server);
+      server(rdv, params, isSST);
+    }
+  }
+  MPI_Finalize();
+  return 0;
+}
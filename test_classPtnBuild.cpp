@@ -0,0 +1,60 @@
+#include <iostream>
+#include <cstdlib>
+#include <algorithm> //max_element
+#include "redev.h"
+
+using ModelEnt = redev::ClassPtn::ModelEnt;
+
+redev::Reals partLoads(const redev::ClassPtn& ptn,
+    const std::map<ModelEnt,redev::Real>& entWt, redev::LO numParts) {
+  redev::Reals load(numParts, 0);
+  for(const auto& [ent, wt] : entWt) {
+    const auto owner = ptn.GetRank(ent);
+    REDEV_ALWAYS_ASSERT(owner >= 0 && owner < numParts);
+    load[owner] += wt;
+  }
+  return load;
+}
+
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  { //model faces and regions with skewed weights, each rank contributes the
+    //mesh entity counts of its part of the mesh
+    std::map<ModelEnt,redev::Real> entWt;
+    redev::ClassPtn::ModelEntVec ents;
+    redev::Reals wts;
+    for(int id=0; id<40; id++) {
+      const ModelEnt ent{2+id%2, id};
+      const redev::Real wt = 1 + (id*id)%97;
+      entWt[ent] = wt*nproc;
+      ents.push_back(ent);
+      wts.push_back(wt);
+    }
+    const redev::LO numParts = 4;
+    auto ptn = redev::BuildClassPtn(MPI_COMM_WORLD, ents, wts, numParts);
+    ptn.Broadcast(MPI_COMM_WORLD);
+    REDEV_ALWAYS_ASSERT(ptn.GetModelEnts().size() == entWt.size());
+    const auto load = partLoads(ptn, entWt, numParts);
+    redev::Real tot = 0;
+    for(auto l : load) tot += l;
+    const auto maxLoad = *std::max_element(load.begin(), load.end());
+    REDEV_ALWAYS_ASSERT(maxLoad/(tot/numParts) < 1.05);
+  }
+  { //adjacent entities are kept together when the balance allows it
+    const ModelEnt faceA{2,0}, regionA{3,0}, faceB{2,1}, regionB{3,1};
+    const auto ents = rank==0 ? redev::ClassPtn::ModelEntVec{faceA,regionA,faceB,regionB}
+                              : redev::ClassPtn::ModelEntVec{};
+    const auto wts = rank==0 ? redev::Reals{1,1,1,1} : redev::Reals{};
+    const redev::ModelEntAdjacency adjacent{{faceA,regionA},{faceB,regionB}};
+    auto ptn = redev::BuildClassPtn(MPI_COMM_WORLD, ents, wts, 2, adjacent);
+    ptn.Broadcast(MPI_COMM_WORLD);
+    REDEV_ALWAYS_ASSERT(ptn.GetRank(faceA) == ptn.GetRank(regionA));
+    REDEV_ALWAYS_ASSERT(ptn.GetRank(faceB) == ptn.GetRank(regionB));
+    REDEV_ALWAYS_ASSERT(ptn.GetRank(faceA) != ptn.GetRank(faceB));
+  }
+  MPI_Finalize();
+  return 0;
+}
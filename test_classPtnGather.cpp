@@ -23,7 +23,7 @@ void test1(const int rank, const EntToRank& expectedE2R) {
   auto ranks = rank==0 ? redev::LOs({0,1}) : redev::LOs({2,3});
   auto ents = rank==0 ? MdlEntVec({{0,0},{1,0}}) : MdlEntVec({{2,0},{2,1}}) ;
   auto partition = redev::ClassPtn(MPI_COMM_WORLD,ranks,ents);
-  if(!rank) check(partition,expectedE2R);
+  check(partition,expectedE2R);
 }
 
 /**
@@ -33,7 +33,7 @@ void test2(const int rank, const EntToRank& expectedE2R) {
   auto ranks = rank==0 ? redev::LOs({0,1,2,3}) : redev::LOs();
   auto ents = rank==0 ? MdlEntVec({{0,0},{1,0},{2,0},{2,1}}) : MdlEntVec() ;
   auto partition = redev::ClassPtn(MPI_COMM_WORLD,ranks,ents);
-  if(!rank) check(partition,expectedE2R);
+  check(partition,expectedE2R);
 }
 
 /**
@@ -43,7 +43,19 @@ void test3(const int rank, const EntToRank& expectedE2R) {
   auto ranks = rank!=0 ? redev::LOs({0,1,2,3}) : redev::LOs();
   auto ents = rank!=0 ? MdlEntVec({{0,0},{1,0},{2,0},{2,1}}) : MdlEntVec() ;
   auto partition = redev::ClassPtn(MPI_COMM_WORLD,ranks,ents);
-  if(!rank) check(partition,expectedE2R);
+  check(partition,expectedE2R);
+}
+
+/**
+ * partition data split across two ranks with entities passed by both ranks
+ */
+void test4(const int rank, const EntToRank& expectedE2R) {
+  auto ranks = rank==0 ? redev::LOs({2,0,1}) : redev::LOs({1,3,2});
+  auto ents = rank==0 ? MdlEntVec({{2,0},{0,0},{1,0}}) : MdlEntVec({{1,0},{2,1},{2,0}}) ;
+  auto partition = redev::ClassPtn(MPI_COMM_WORLD,ranks,ents);
+  check(partition,expectedE2R);
+  for(auto& [ent,owner] : expectedE2R)
+    REDEV_ALWAYS_ASSERT(partition.GetRank(ent) == owner);
 }
 
 int main(int argc, char** argv) {
@@ -64,6 +76,7 @@ int main(int argc, char** argv) {
   test1(rank, expectedE2R);
   test2(rank, expectedE2R);
   test3(rank, expectedE2R);
+  test4(rank, expectedE2R);
 
   MPI_Finalize();
   return 0;
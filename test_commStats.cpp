@@ -0,0 +1,88 @@
+#include <iostream>
+#include <sstream>
+#include "redev.h"
+
+void histogramTest() {
+  redev::LatencyHistogram h;
+  REDEV_ALWAYS_ASSERT(h.Count() == 0);
+  REDEV_ALWAYS_ASSERT(h.Quantile(0.5) == 0);
+  h.Add(0);       //bin 0
+  h.Add(3e-6);    //bin 1, [2,4) us
+  h.Add(100e-6);  //bin 6, [64,128) us
+  h.Add(1e6);     //last bin
+  REDEV_ALWAYS_ASSERT(h.Count() == 4);
+  REDEV_ALWAYS_ASSERT(h.GetCounts()[0] == 1);
+  REDEV_ALWAYS_ASSERT(h.GetCounts()[1] == 1);
+  REDEV_ALWAYS_ASSERT(h.GetCounts()[6] == 1);
+  REDEV_ALWAYS_ASSERT(h.GetCounts()[redev::LatencyHistogram::numBins-1] == 1);
+  REDEV_ALWAYS_ASSERT(h.Quantile(0.5) == 4e-6);
+  REDEV_ALWAYS_ASSERT(h.Quantile(0.75) == 128e-6);
+  redev::LatencyHistogram g;
+  g.Add(3e-6);
+  g.Merge(h);
+  REDEV_ALWAYS_ASSERT(g.Count() == 5);
+  REDEV_ALWAYS_ASSERT(g.GetCounts()[1] == 2);
+  g.Reset();
+  REDEV_ALWAYS_ASSERT(g.Count() == 0);
+}
+
+void mergeTest() {
+  redev::CommStats a;
+  a.sends = 1;
+  a.bytesSent = 16;
+  a.bytesSentPerDest = {8,8};
+  a.transferSeconds = 1;
+  a.sendLatency.Add(1e-3);
+  redev::CommStats b;
+  b.recvs = 2;
+  b.bytesSentPerDest = {1,2,3};
+  b.transferSeconds = 2;
+  b.sendLatency.Add(1e-3);
+  a.Merge(b);
+  REDEV_ALWAYS_ASSERT(a.sends == 1);
+  REDEV_ALWAYS_ASSERT(a.recvs == 2);
+  REDEV_ALWAYS_ASSERT(a.bytesSent == 16);
+  REDEV_ALWAYS_ASSERT(a.bytesSentPerDest == redev::GOs({9,10,3}));
+  REDEV_ALWAYS_ASSERT(a.transferSeconds == 3);
+  REDEV_ALWAYS_ASSERT(a.sendLatency.Count() == 2);
+  a.Reset();
+  REDEV_ALWAYS_ASSERT(a.sends == 0);
+  REDEV_ALWAYS_ASSERT(a.bytesSentPerDest.empty());
+  REDEV_ALWAYS_ASSERT(a.sendLatency.Count() == 0);
+}
+
+/**
+ * each rank sends rank+1 bytes and spends rank+1 seconds in the step calls so
+ * the last rank is the slowest
+ */
+void reportTest(const int rank, const int nproc) {
+  redev::CommStats stats;
+  stats.bytesSent = rank+1;
+  stats.stepSeconds = rank+1;
+  stats.stepLatency.Add(1e-6);
+  auto report = redev::Report(stats, MPI_COMM_WORLD, 2);
+  REDEV_ALWAYS_ASSERT(report.commSize == nproc);
+  REDEV_ALWAYS_ASSERT(report.bytesSent.min == 1);
+  REDEV_ALWAYS_ASSERT(report.bytesSent.minRank == 0);
+  REDEV_ALWAYS_ASSERT(report.bytesSent.max == nproc);
+  REDEV_ALWAYS_ASSERT(report.bytesSent.maxRank == nproc-1);
+  REDEV_ALWAYS_ASSERT(report.bytesSent.avg == (nproc+1)/2.0);
+  REDEV_ALWAYS_ASSERT(report.stepLatency.Count() == nproc);
+  REDEV_ALWAYS_ASSERT(report.slowestRanks.size() == static_cast<size_t>(std::min(2,nproc)));
+  REDEV_ALWAYS_ASSERT(report.slowestRanks[0] == nproc-1);
+  std::stringstream ss;
+  ss << report;
+  REDEV_ALWAYS_ASSERT(!ss.str().empty());
+}
+
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  histogramTest();
+  mergeTest();
+  reportTest(rank, nproc);
+  MPI_Finalize();
+  return 0;
+}
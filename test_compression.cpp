@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cstdlib>
+#include "redev.h"
+
+// Send with the default lossless compression of the ADIOS2 build, see
+// redev::DefaultCompression, and check the received values. The message
+// layout of a communicator is fixed after its first send so each message size
+// uses its own communicator; the sizes are on both sides of the
+// Compression::minBytes threshold so some communicators attach the operator
+// and others do not. Without an operator in the ADIOS2 build this is a plain
+// send/receive test.
+
+namespace {
+  const size_t minBytes = 16*1024;
+  //items sent by each non-rendezvous rank, one communicator per count
+  const std::vector<size_t> counts{100000, 10, 100, 200000};
+  const int steps = 2;
+
+  redev::LO value(int rank, size_t i) {
+    return static_cast<redev::LO>(rank*1000000 + i/8);
+  }
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int rank, nproc;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  if(argc != 3) {
+    if(!rank)
+      std::cerr << "Usage: " << argv[0] << " <1=isRendezvousApp,0=isParticipant> <rdvRanks>\n";
+    exit(EXIT_FAILURE);
+  }
+  const auto isRdv = atoi(argv[1]);
+  const auto rdvRanks = atoi(argv[2]);
+  REDEV_ALWAYS_ASSERT(!isRdv || rdvRanks == nproc);
+  {
+    //the cuts won't be used since GetRank(...) won't be called
+    const auto dim = 1;
+    auto ranks = redev::LOs(rdvRanks);
+    auto cuts = redev::Reals(rdvRanks);
+    auto ptn = redev::RCBPtn(dim, ranks, cuts);
+    redev::Redev rdv(MPI_COMM_WORLD, redev::Partition{std::move(ptn)},
+        static_cast<redev::ProcessType>(isRdv));
+    adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "12"}};
+    auto channel = rdv.CreateAdiosChannel("compression", params);
+    const auto compression = redev::DefaultCompression(minBytes);
+    REDEV_ALWAYS_ASSERT(compression.minBytes == minBytes);
+    if(!rank)
+      std::cout << "compression operator '" << compression.type << "'\n";
+    for(size_t c=0; c<counts.size(); c++) {
+      const auto count = counts[c];
+      auto comm = channel.CreateComm<redev::LO>("fields" + std::to_string(c),
+          rdv.GetMPIComm(), compression);
+      for(int step=0; step<steps; step++) {
+        if(!isRdv) {
+          //all items to rendezvous rank rank%rdvRanks
+          redev::LOs dest{rank%rdvRanks};
+          redev::LOs offsets{0, static_cast<redev::LO>(count)};
+          redev::LOs msgs(count);
+          for(size_t i=0; i<count; i++)
+            msgs[i] = value(rank, i+step);
+          comm.SetOutMessageLayout(dest, offsets);
+          channel.SendPhase([&]() { comm.Send(msgs.data(), redev::Mode::Synchronous); });
+        } else {
+          const auto msgs = channel.ReceivePhase([&]() { return comm.Recv(redev::Mode::Synchronous); });
+          const auto in = comm.GetInMessageLayout();
+          REDEV_ALWAYS_ASSERT(msgs.size() == in.count);
+          const auto numSenders = in.srcRanks.size()/rdvRanks;
+          size_t expected = 0;
+          for(size_t s=0; s<numSenders; s++) {
+            if(static_cast<int>(s)%rdvRanks != rank)
+              continue;
+            expected += count;
+            const auto start = in.srcRanks[s*rdvRanks+rank];
+            for(size_t i=0; i<count; i++)
+              REDEV_ALWAYS_ASSERT(msgs[start+i] == value(s, i+step));
+          }
+          REDEV_ALWAYS_ASSERT(msgs.size() == expected);
+        }
+      }
+    }
+  }
+  MPI_Finalize();
+  return 0;
+}
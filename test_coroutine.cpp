@@ -0,0 +1,114 @@
+#include <iostream>
+#include <cstdlib>
+#include "redev_coroutine.h"
+
+// The rendezvous and non-rendezvous applications are coupled by two channels
+// and run one coroutine per channel on a redev::coro::Executor. On the
+// non-rendezvous side the coroutine of channel 1 computes, yields, and waits
+// for an MPI_Iallreduce before each send, so the rendezvous side services
+// channel 0 while channel 1 is not ready. Each rank sends its rank plus the
+// channel and step to rendezvous rank 0 and gets the value plus 1000 back.
+
+namespace {
+  const int steps = 3;
+
+  redev::LO value(int channel, int step, int rank) {
+    return channel*100+step*10+rank;
+  }
+}
+
+redev::coro::Task<> client(redev::Channel& channel, redev::BidirectionalComm<redev::LO>& c, int id) {
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  redev::coro::AsyncChannel ch(channel);
+  redev::coro::AsyncComm<redev::LO> comm(channel, c);
+  redev::LOs dest{0};
+  redev::LOs offsets{0,1};
+  c.SetOutMessageLayout(dest, offsets);
+  for(int step=0; step<steps; step++) {
+    if(id == 1) {
+      //local compute overlapped with a nonblocking collective
+      int local = step, sum = 0;
+      MPI_Request request;
+      MPI_Iallreduce(&local, &sum, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD, &request);
+      for(int i=0; i<3; i++)
+        co_await redev::coro::Yield{};
+      co_await redev::coro::Wait(request);
+      int nproc;
+      MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+      REDEV_ALWAYS_ASSERT(sum == step*nproc);
+    }
+    redev::LOs msgs(1, value(id, step, rank));
+    co_await comm.AsyncSend(msgs.data());
+    co_await ch.AsyncEndSendPhase();
+    auto reply = co_await comm.AsyncRecv(redev::Mode::Synchronous);
+    co_await ch.AsyncEndReceivePhase();
+    REDEV_ALWAYS_ASSERT(reply.size() == 1);
+    REDEV_ALWAYS_ASSERT(reply[0] == 1000+value(id, step, rank));
+  }
+}
+
+redev::coro::Task<> server(redev::Channel& channel, redev::BidirectionalComm<redev::LO>& c, int id) {
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  redev::coro::AsyncChannel ch(channel);
+  redev::coro::AsyncComm<redev::LO> comm(channel, c);
+  for(int step=0; step<steps; step++) {
+    co_await ch.AsyncBeginReceivePhase();
+    auto msgs = co_await comm.AsyncRecv(redev::Mode::Synchronous);
+    co_await ch.AsyncEndReceivePhase();
+    //reply to each sender with its value plus 1000
+    const auto in = c.GetInMessageLayout();
+    redev::LOs dest, offsets{0};
+    redev::LOs reply;
+    if(!rank) {
+      const auto numSenders = static_cast<redev::LO>(msgs.size());
+      for(redev::LO s=0; s<numSenders; s++) {
+        REDEV_ALWAYS_ASSERT(msgs[s] == value(id, step, s));
+        dest.push_back(s);
+        offsets.push_back(s+1);
+        reply.push_back(msgs[s]+1000);
+      }
+    } else {
+      REDEV_ALWAYS_ASSERT(in.count == 0);
+    }
+    c.SetOutMessageLayout(dest, offsets);
+    co_await comm.AsyncSend(reply.data());
+    co_await ch.AsyncEndSendPhase();
+  }
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if(argc != 2) {
+    if(!rank)
+      std::cerr << "Usage: " << argv[0] << " <1=isRendezvousApp,0=isParticipant>\n";
+    exit(EXIT_FAILURE);
+  }
+  const auto isRdv = atoi(argv[1]);
+  {
+    //the cuts won't be used since GetRank(...) won't be called
+    const auto dim = 1;
+    auto ranks = redev::LOs({0});
+    auto cuts = redev::Reals({0});
+    auto ptn = redev::RCBPtn(dim, ranks, cuts);
+    redev::Redev rdv(MPI_COMM_WORLD, redev::Partition{std::move(ptn)},
+        static_cast<redev::ProcessType>(isRdv));
+    adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "12"}};
+    std::vector<redev::Channel> channels;
+    std::vector<redev::BidirectionalComm<redev::LO>> comms;
+    for(int i=0; i<2; i++) {
+      const auto name = "coroutine" + std::to_string(i);
+      channels.push_back(rdv.CreateAdiosChannel(name, params));
+      comms.push_back(channels.back().CreateComm<redev::LO>(name, rdv.GetMPIComm()));
+    }
+    redev::coro::Executor executor(rdv.GetMPIComm());
+    for(int i=0; i<2; i++)
+      executor.Spawn(isRdv ? server(channels[i], comms[i], i) : client(channels[i], comms[i], i));
+    executor.Run();
+  }
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <iostream>
+#include <cstdlib>
+#include <numeric>
+#include "redev.h"
+
+using MdlEntVec = redev::DistributedClassPtn::ModelEntVec;
+
+//the owner of entity (dim,id) in the tests below
+redev::LO expectedOwner(redev::LO dim, redev::LO id, int nproc) {
+  return (dim*7+id)%nproc;
+}
+
+/**
+ * each rank passes a strided subset of the assignment, with overlap
+ */
+redev::DistributedClassPtn create(const int rank, const int nproc, const redev::LO numPerDim) {
+  redev::LOs ranks;
+  MdlEntVec ents;
+  for(redev::LO dim=0; dim<=3; dim++) {
+    for(redev::LO id=0; id<numPerDim; id++) {
+      //entities with id%4==0 are passed by all ranks
+      if(id%nproc == rank || id%4 == 0) {
+        ents.push_back({dim,id});
+        ranks.push_back(expectedOwner(dim,id,nproc));
+      }
+    }
+  }
+  return redev::DistributedClassPtn(MPI_COMM_WORLD,ranks,ents);
+}
+
+/**
+ * every entity is stored on exactly one rank
+ */
+void testLocalSize(const redev::DistributedClassPtn& ptn, const redev::LO numPerDim) {
+  unsigned long localSize = ptn.GetLocalSize();
+  unsigned long totalSize = 0;
+  MPI_Allreduce(&localSize, &totalSize, 1, MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
+  REDEV_ALWAYS_ASSERT(totalSize == static_cast<unsigned long>(4*numPerDim));
+}
+
+/**
+ * each rank queries a different number of entities, rank 0 has none
+ */
+void testQuery(const redev::DistributedClassPtn& ptn, const int rank, const int nproc,
+    const redev::LO numPerDim) {
+  MdlEntVec query;
+  for(redev::LO i=0; i<rank*13; i++)
+    query.push_back({(i+rank)%4, (i*5+rank)%numPerDim});
+  auto owners = ptn.GetRanks(query);
+  REDEV_ALWAYS_ASSERT(owners.size() == query.size());
+  for(size_t i=0; i<query.size(); i++)
+    REDEV_ALWAYS_ASSERT(owners[i] == expectedOwner(query[i].first, query[i].second, nproc));
+}
+
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  const redev::LO numPerDim = 100;
+  auto ptn = create(rank, nproc, numPerDim);
+  testLocalSize(ptn, numPerDim);
+  testQuery(ptn, rank, nproc, numPerDim);
+  //repeat with the cache enabled, the second pass is answered from the cache
+  ptn.SetCacheCapacity(16);
+  REDEV_ALWAYS_ASSERT(ptn.GetCacheCapacity() == 16);
+  testQuery(ptn, rank, nproc, numPerDim);
+  testQuery(ptn, rank, nproc, numPerDim);
+  ptn.SetCacheCapacity(1024);
+  testQuery(ptn, rank, nproc, numPerDim);
+  testQuery(ptn, rank, nproc, numPerDim);
+  //the table is not replicated by Broadcast
+  ptn.Broadcast(MPI_COMM_WORLD);
+  testLocalSize(ptn, numPerDim);
+  MPI_Finalize();
+  return 0;
+}
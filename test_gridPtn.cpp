@@ -0,0 +1,53 @@
+#include <iostream>
+#include <cstdlib>
+#include <limits>
+#include "redev.h"
+
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  /* rendezvous domain: 3x2 grid with origin (-1,0) and spacing (0.5,1)
+   *
+   * 2.0 +----+----+----+
+   *     |  3 |  4 |  5 |
+   * 1.0 +----+----+----+
+   *     |  0 |  1 |  2 |
+   * 0.0 +----+----+----+
+   *   -1.0 -0.5  0.0  0.5
+   */
+  const auto dim = 2;
+  const std::array<redev::Real,3> origin{-1.0, 0.0, 0.0};
+  const std::array<redev::Real,3> spacing{0.5, 1.0, 0.0};
+  const std::array<redev::LO,3> cells{3, 2, 0};
+  const redev::LOs expectedRanks{0,1,2,3,4,5};
+  auto ptn = rank==0 ? redev::GridPtn(dim,origin,spacing,cells,expectedRanks)
+                     : redev::GridPtn();
+  ptn.Broadcast(MPI_COMM_WORLD);
+  REDEV_ALWAYS_ASSERT(ptn.GetRanks() == expectedRanks);
+  REDEV_ALWAYS_ASSERT((ptn.GetCells() == std::array<redev::LO,3>{3,2,1}));
+  REDEV_ALWAYS_ASSERT(ptn.GetOrigin()[0] == -1.0);
+  REDEV_ALWAYS_ASSERT(ptn.GetSpacing()[0] == 0.5);
+  using Point = std::array<redev::Real,3>;
+  REDEV_ALWAYS_ASSERT(0 == ptn.GetRank(Point{-0.9, 0.1, 0.0}));
+  REDEV_ALWAYS_ASSERT(1 == ptn.GetRank(Point{-0.5, 0.5, 7.0})); //z is ignored
+  REDEV_ALWAYS_ASSERT(2 == ptn.GetRank(Point{0.25, 0.99, 0.0}));
+  REDEV_ALWAYS_ASSERT(3 == ptn.GetRank(Point{-0.75, 1.0, 0.0}));
+  REDEV_ALWAYS_ASSERT(5 == ptn.GetRank(Point{0.4, 1.9, 0.0}));
+  //points outside the grid belong to the nearest boundary cell
+  REDEV_ALWAYS_ASSERT(0 == ptn.GetRank(Point{-5.0, -5.0, 0.0}));
+  REDEV_ALWAYS_ASSERT(5 == ptn.GetRank(Point{5.0, 5.0, 0.0}));
+  REDEV_ALWAYS_ASSERT(4 == ptn.GetRank(Point{-0.25, 1e300, 0.0}));
+  //batched queries return the same owners as single queries
+  const redev::Reals pts{-0.9,0.1,0,  -0.5,0.5,7,  0.25,0.99,0,
+                         -0.75,1.0,0,  0.4,1.9,0,  -5,-5,0,  5,5,0};
+  const auto owners = ptn.GetRank(pts);
+  REDEV_ALWAYS_ASSERT(owners == redev::LOs({0,1,2,3,5,0,5}));
+  //the ignored z coordinate may be non-finite
+  const auto nan = std::numeric_limits<redev::Real>::quiet_NaN();
+  REDEV_ALWAYS_ASSERT(1 == ptn.GetRank(Point{-0.5, 0.5, nan}));
+  REDEV_ALWAYS_ASSERT(ptn.GetRank(redev::Reals{-0.5, 0.5, nan}) == redev::LOs{1});
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,56 @@
+#include <iostream>
+#include <cstdlib>
+#include "redev.h"
+
+/**
+ * the 2D RCB partition from test_query is defined on rank 0 and sent to the
+ * other ranks in node shared memory
+ */
+void rcbTest(const int rank) {
+  const auto dim = 2;
+  std::vector<redev::LO> ranks = {0,1,2,3};
+  std::vector<redev::Real> cuts = {0,0.5,0.75,0.25};
+  auto ptn = rank==0 ? redev::RCBPtn(dim,ranks,cuts) : redev::RCBPtn(dim);
+  ptn.BroadcastNodeShared(MPI_COMM_WORLD);
+  REDEV_ALWAYS_ASSERT(ptn.GetRanks() == ranks);
+  REDEV_ALWAYS_ASSERT(ptn.GetCuts() == cuts);
+  std::array<redev::Real,3> pt{0.1, 0.7, 0.0};
+  pt[0] = 0.1, pt[1] = 0.7; REDEV_ALWAYS_ASSERT(0 == ptn.GetRank(pt));
+  pt[0] = 0.1; pt[1] = 0.8; REDEV_ALWAYS_ASSERT(1 == ptn.GetRank(pt));
+  pt[0] = 0.5; pt[1] = 0.0; REDEV_ALWAYS_ASSERT(2 == ptn.GetRank(pt));
+  pt[0] = 0.7; pt[1] = 0.9; REDEV_ALWAYS_ASSERT(3 == ptn.GetRank(pt));
+  //copies refer to the same window
+  auto copy = ptn;
+  REDEV_ALWAYS_ASSERT(copy.GetCuts() == cuts);
+  //a later broadcast replaces the shared window with a copy on each rank
+  ptn.Broadcast(MPI_COMM_WORLD);
+  REDEV_ALWAYS_ASSERT(ptn.GetCuts() == cuts);
+}
+
+/**
+ * the class partition is sent from the last rank
+ */
+void classTest(const int rank, const int nproc) {
+  using ModelEnt = redev::ClassPtn::ModelEnt;
+  const redev::LOs ranks = {0,1,2,3};
+  const redev::ClassPtn::ModelEntVec ents {{0,0},{1,0},{2,0},{2,1}};
+  const int root = nproc-1;
+  auto ptn = redev::ClassPtn(MPI_COMM_SELF, rank==root ? ranks : redev::LOs(),
+      rank==root ? ents : redev::ClassPtn::ModelEntVec());
+  ptn.BroadcastNodeShared(MPI_COMM_WORLD, root);
+  REDEV_ALWAYS_ASSERT(ptn.GetRanks() == ranks);
+  REDEV_ALWAYS_ASSERT(ptn.GetModelEnts() == ents);
+  for(size_t i=0; i<ents.size(); i++)
+    REDEV_ALWAYS_ASSERT(ranks[i] == ptn.GetRank(ModelEnt(ents[i])));
+}
+
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  rcbTest(rank);
+  classTest(rank, nproc);
+  MPI_Finalize();
+  return 0;
+}
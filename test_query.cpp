@@ -33,6 +33,8 @@ int main(int argc, char** argv) {
     pt[0] = 0.01;  REDEV_ALWAYS_ASSERT(0 == ptn.GetRank(pt));
     pt[0] = 0.5;   REDEV_ALWAYS_ASSERT(2 == ptn.GetRank(pt));
     pt[0] = 0.751; REDEV_ALWAYS_ASSERT(3 == ptn.GetRank(pt));
+    const redev::Reals pts = {0.6,0,0, 0.01,0,0, 0.5,0,0, 0.751,0,0};
+    REDEV_ALWAYS_ASSERT(ptn.GetRank(pts) == redev::LOs({2,0,2,3}));
   }
   { //2D RCB
     const auto dim = 2;
@@ -55,6 +57,18 @@ int main(int argc, char** argv) {
     pt[0] = 0.1; pt[1] = 0.8; REDEV_ALWAYS_ASSERT(1 == ptn.GetRank(pt));
     pt[0] = 0.5; pt[1] = 0.0; REDEV_ALWAYS_ASSERT(2 == ptn.GetRank(pt));
     pt[0] = 0.7; pt[1] = 0.9; REDEV_ALWAYS_ASSERT(3 == ptn.GetRank(pt));
+    //box queries
+    using Point = std::array<redev::Real,3>;
+    const redev::Reals boxMins = {0.1,0.1,0, 0.4,0.7,0, 0.0,0.0,0, 0.5,0.1,0};
+    const redev::Reals boxMaxs = {0.2,0.2,0, 0.6,0.8,0, 1.0,1.0,0, 0.6,0.2,0};
+    const redev::LOs expectedOffsets = {0,1,4,8,9};
+    const redev::LOs expectedRanks = {0, 0,1,3, 0,1,2,3, 2};
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks(Point{0.1,0.1,0},Point{0.2,0.2,0}) == redev::LOs({0}));
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks(Point{0.4,0.7,0},Point{0.6,0.8,0}) == redev::LOs({0,1,3}));
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks(Point{0.5,0.1,0},Point{0.6,0.2,0}) == redev::LOs({2}));
+    auto boxRanks = ptn.GetRanks(boxMins,boxMaxs);
+    REDEV_ALWAYS_ASSERT(boxRanks.offsets == expectedOffsets);
+    REDEV_ALWAYS_ASSERT(boxRanks.ranks == expectedRanks);
   }
   { //3D RCB
     const auto dim = 3;
@@ -72,6 +86,17 @@ int main(int argc, char** argv) {
     { Point pt{0.6, 0.1, 0.9};  REDEV_ALWAYS_ASSERT(5 == ptn.GetRank(pt)); }
     { Point pt{0.6, 0.8, 0.0};  REDEV_ALWAYS_ASSERT(6 == ptn.GetRank(pt)); }
     { Point pt{0.6, 0.8, 0.3};  REDEV_ALWAYS_ASSERT(7 == ptn.GetRank(pt)); }
+    //batched queries in double and single precision
+    const redev::Reals pts = {0.1,0.7,0.01, 0.1,0.7,0.1, 0.1,0.8,0.1, 0.1,0.8,0.8,
+                              0.6,0.1,0.01, 0.6,0.1,0.9, 0.6,0.8,0.0, 0.6,0.8,0.3};
+    REDEV_ALWAYS_ASSERT(ptn.GetRank(pts) == ranks);
+    const std::vector<float> ptsFloat(pts.begin(), pts.end());
+    REDEV_ALWAYS_ASSERT(ptn.GetRank(ptsFloat) == ranks);
+    //box queries
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks(Point{0,0,0},Point{1,1,1}) == ranks);
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks(Point{0.1,0.7,0.01},Point{0.1,0.7,0.01}) == redev::LOs({0}));
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks(Point{0.1,0.7,0.0},Point{0.1,0.8,0.2}) == redev::LOs({0,1,2}));
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks(Point{0.6,0.1,0.3},Point{0.7,0.9,0.35}) == redev::LOs({4,7}));
   }
 
   MPI_Finalize();
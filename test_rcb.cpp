@@ -7,13 +7,23 @@ int main(int argc, char** argv) {
   MPI_Comm_size(MPI_COMM_WORLD, &nproc);
   const auto expectedRanks = redev::LOs({0,1,2,3});
   const auto expectedCuts = redev::Reals({0,0.5,0.75,0.25});
-  auto ranks = rank==0 ? expectedRanks : redev::LOs();
-  auto cuts = rank==0 ? expectedCuts : redev::Reals();
+  auto ranks = expectedRanks;
+  auto cuts = expectedCuts;
   const auto dim = 2;
-  auto ptn = redev::RCBPtn(dim,ranks,cuts);
+  //the other ranks start from a default partition, as clients do
+  auto ptn = rank==0 ? redev::RCBPtn(dim,ranks,cuts) : redev::RCBPtn();
   ptn.Broadcast(MPI_COMM_WORLD);
   REDEV_ALWAYS_ASSERT(ptn.GetRanks() == expectedRanks);
   REDEV_ALWAYS_ASSERT(ptn.GetCuts() == expectedCuts);
+  std::array<redev::Real,3> pt{0.6,0.9,0};
+  REDEV_ALWAYS_ASSERT(ptn.GetRank(pt) == 3);
+  //placeholder partitions with one cut per rank are accepted, only queries
+  //need a power of two
+  auto placeholderRanks = redev::LOs(3);
+  auto placeholderCuts = redev::Reals(3);
+  auto placeholder = redev::RCBPtn(dim,placeholderRanks,placeholderCuts);
+  placeholder.Broadcast(MPI_COMM_WORLD);
+  REDEV_ALWAYS_ASSERT(placeholder.GetRanks().size() == 3);
   MPI_Finalize();
   return 0;
 }
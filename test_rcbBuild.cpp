@@ -0,0 +1,66 @@
+#include <iostream>
+#include <cstdlib>
+#include <algorithm> //max_element
+#include "redev.h"
+
+// Sum the weight of the points in each sub-domain across all ranks and check
+// that the heaviest sub-domain is within 'tol' of the average.
+void checkBalance(MPI_Comm comm, const redev::RCBPtn& ptn, const redev::Reals& pts,
+    const redev::Reals& wts, redev::LO numParts, double tol) {
+  redev::Reals partWt(numParts, 0);
+  for(size_t i=0; i<pts.size()/3; i++) {
+    std::array<redev::Real,3> pt{pts[3*i], pts[3*i+1], pts[3*i+2]};
+    const auto owner = ptn.GetRank(pt);
+    REDEV_ALWAYS_ASSERT(owner>=0 && owner<numParts);
+    partWt[owner] += wts.empty() ? 1 : wts[i];
+  }
+  MPI_Allreduce(MPI_IN_PLACE, partWt.data(), numParts, MPI_DOUBLE, MPI_SUM, comm);
+  double tot = 0;
+  for(auto w : partWt) tot += w;
+  const auto maxWt = *std::max_element(partWt.begin(), partWt.end());
+  const auto imb = maxWt/(tot/numParts);
+  REDEV_ALWAYS_ASSERT(imb < 1+tol);
+}
+
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  //points clustered towards the origin, each rank owns a different subset
+  const int ptsPerRank = 2000;
+  redev::Reals pts;
+  redev::Reals wts;
+  for(int i=0; i<ptsPerRank; i++) {
+    const auto u = static_cast<double>(i*nproc+rank)/(ptsPerRank*nproc);
+    const auto v = static_cast<double>((i*7919+rank*104729)%(ptsPerRank*nproc))/(ptsPerRank*nproc);
+    pts.insert(pts.end(), {u*u, v, (u+v)/2});
+    wts.push_back(1 + (i%3));
+  }
+  { //2D, one sub-domain per rank, unit weights
+    const auto dim = 2;
+    auto ptn = redev::BuildRCBPtn(MPI_COMM_WORLD, dim, pts);
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks().size() == static_cast<size_t>(nproc));
+    checkBalance(MPI_COMM_WORLD, ptn, pts, {}, nproc, 0.01);
+    //every rank computes the same tree
+    auto cuts = ptn.GetCuts();
+    auto rootCuts = cuts;
+    MPI_Bcast(rootCuts.data(), rootCuts.size(), MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    REDEV_ALWAYS_ASSERT(cuts == rootCuts);
+  }
+  { //3D, more sub-domains than ranks, weighted points
+    const auto dim = 3;
+    const redev::LO numParts = 4*nproc;
+    auto ptn = redev::BuildRCBPtn(MPI_COMM_WORLD, dim, pts, wts, numParts);
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks().size() == static_cast<size_t>(numParts));
+    checkBalance(MPI_COMM_WORLD, ptn, pts, wts, numParts, 0.05);
+  }
+  { //a single sub-domain owns everything
+    const auto dim = 2;
+    auto ptn = redev::BuildRCBPtn(MPI_COMM_WORLD, dim, pts, wts, 1);
+    std::array<redev::Real,3> pt{0.5,0.5,0};
+    REDEV_ALWAYS_ASSERT(ptn.GetRank(pt) == 0);
+  }
+  MPI_Finalize();
+  return 0;
+}
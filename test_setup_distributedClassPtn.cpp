@@ -0,0 +1,53 @@
+#include <iostream>
+#include <cstdlib>
+#include "redev.h"
+
+using MdlEntVec = redev::DistributedClassPtn::ModelEntVec;
+
+void distributedClassPtnTest(int rank, int nproc, bool isRdv) {
+  //each rendezvous rank passes the entities with id%nproc == rank
+  const redev::LO numPerDim = 50;
+  redev::LOs ranks;
+  MdlEntVec ents;
+  if(isRdv) {
+    for(redev::LO dim=0; dim<=3; dim++) {
+      for(redev::LO id=rank; id<numPerDim; id+=nproc) {
+        ents.push_back({dim,id});
+        ranks.push_back(id%3);
+      }
+    }
+  }
+  redev::Redev rdv(MPI_COMM_WORLD,redev::Partition{std::in_place_type<redev::DistributedClassPtn>, MPI_COMM_WORLD,ranks,ents},static_cast<redev::ProcessType>(isRdv));
+  adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "2"}};
+  auto channel = rdv.CreateAdiosChannel("foo", params,
+                                                    redev::TransportType::BP4);
+  auto commPair = channel.CreateComm<redev::LO>("foo", MPI_COMM_WORLD);
+  if(!isRdv) {
+    const auto& partition = std::get<redev::DistributedClassPtn>(rdv.GetPartition());
+    unsigned long localSize = partition.GetLocalSize();
+    unsigned long totalSize = 0;
+    MPI_Allreduce(&localSize, &totalSize, 1, MPI_UNSIGNED_LONG, MPI_SUM, MPI_COMM_WORLD);
+    REDEV_ALWAYS_ASSERT(totalSize == 4*numPerDim);
+    MdlEntVec query;
+    for(redev::LO id=rank; id<numPerDim; id++)
+      query.push_back({id%4,id});
+    auto owners = partition.GetRanks(query);
+    for(size_t i=0; i<query.size(); i++)
+      REDEV_ALWAYS_ASSERT(owners[i] == query[i].second%3);
+  }
+}
+
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  if(argc != 2) {
+    std::cerr << "Usage: " << argv[0] << " <1=isRendezvousApp,0=isParticipant>\n";
+    exit(EXIT_FAILURE);
+  }
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  auto isRdv = atoi(argv[1]);
+  distributedClassPtnTest(rank,nproc,isRdv);
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <cstdlib>
+#include <algorithm> //upper_bound
+#include "redev.h"
+
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  using Point = std::array<redev::Real,3>;
+  using Key = redev::SFCPtn::Key;
+  { //2D: the curve visits the quadrants of the unit square in the order
+    //lower left, lower right, upper left, upper right
+    const auto dim = 2;
+    const Point lo{0,0,0};
+    const Point hi{1,1,0};
+    const Key quarter = Key(1) << 62;
+    const redev::SFCPtn::Keys expectedSplitters{0, quarter, 2*quarter, 3*quarter};
+    const redev::LOs expectedRanks{3,2,1,0};
+    auto ptn = rank==0 ? redev::SFCPtn(dim,lo,hi,expectedSplitters,expectedRanks)
+                       : redev::SFCPtn();
+    ptn.Broadcast(MPI_COMM_WORLD);
+    REDEV_ALWAYS_ASSERT(ptn.GetRanks() == expectedRanks);
+    REDEV_ALWAYS_ASSERT(ptn.GetSplitters() == expectedSplitters);
+    REDEV_ALWAYS_ASSERT(ptn.GetKey(Point{0,0,0}) == 0);
+    REDEV_ALWAYS_ASSERT(ptn.GetKey(Point{1,1,0}) == ~Key(0));
+    REDEV_ALWAYS_ASSERT(ptn.GetKey(Point{0.5,0,0}) == quarter);
+    REDEV_ALWAYS_ASSERT(ptn.GetKey(Point{0,0.5,0}) == 2*quarter);
+    REDEV_ALWAYS_ASSERT(3 == ptn.GetRank(Point{0.1, 0.2, 0}));
+    REDEV_ALWAYS_ASSERT(2 == ptn.GetRank(Point{0.6, 0.2, 0}));
+    REDEV_ALWAYS_ASSERT(1 == ptn.GetRank(Point{0.1, 0.7, 0}));
+    REDEV_ALWAYS_ASSERT(0 == ptn.GetRank(Point{0.9, 0.9, 5})); //z is ignored
+    REDEV_ALWAYS_ASSERT(0 == ptn.GetRank(Point{9.0, 9.0, 0})); //clamped
+    //unsorted and sorted batches return the same owners as single queries
+    const redev::Reals pts{0.9,0.9,0,  0.1,0.2,0,  0.1,0.7,0,  0.6,0.2,0};
+    REDEV_ALWAYS_ASSERT(ptn.GetRank(pts) == redev::LOs({0,3,1,2}));
+    const redev::Reals sortedPts{0.1,0.2,0,  0.2,0.1,0,  0.6,0.2,0,  0.9,0.9,0};
+    REDEV_ALWAYS_ASSERT(ptn.GetRank(sortedPts) == redev::LOs({3,3,2,0}));
+  }
+  { //3D: a long splitter table uses the binary search
+    const auto dim = 3;
+    const Point lo{-1,-1,-1};
+    const Point hi{1,1,1};
+    const redev::LO numSegments = 1000;
+    const Key maxKey = (Key(1) << 63);
+    redev::SFCPtn::Keys splitters(numSegments);
+    redev::LOs ranks(numSegments);
+    for(redev::LO i=0; i<numSegments; i++) {
+      splitters[i] = (maxKey/numSegments)*i;
+      ranks[i] = i;
+    }
+    auto ptn = redev::SFCPtn(dim,lo,hi,splitters,ranks);
+    redev::Reals pts;
+    for(int i=0; i<100; i++) {
+      const auto x = -1.0 + 0.02*i;
+      pts.insert(pts.end(), {x, -x*0.5, x*x-0.5});
+    }
+    const auto keys = ptn.GetKeys(pts);
+    const auto owners = ptn.GetRank(pts);
+    for(size_t i=0; i<keys.size(); i++) {
+      const auto expected = std::upper_bound(splitters.begin(), splitters.end(), keys[i]) - splitters.begin() - 1;
+      REDEV_ALWAYS_ASSERT(owners[i] == expected);
+      const Point pt{pts[3*i], pts[3*i+1], pts[3*i+2]};
+      REDEV_ALWAYS_ASSERT(ptn.GetRank(pt) == expected);
+    }
+  }
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <cstdlib>
+#include <thread>
+#include "redev.h"
+
+// Thread-safe mode, see redev::Redev::SetThreadSafe. Within each
+// communication phase, begun and ended by the main thread, every thread of
+// each rank sends or receives on its own communicator. The non-rendezvous
+// rank r sends numThreads*(r+1) items filled with the thread id and rank to
+// rendezvous rank r%rdvRanks on each communicator.
+
+namespace {
+  const int numThreads = 4;
+  const int rounds = 3;
+
+  redev::LO value(int thread, int rank) {
+    return thread*1000+rank;
+  }
+}
+
+int main(int argc, char** argv) {
+  int provided;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+  int rank, nproc;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if(provided != MPI_THREAD_MULTIPLE) {
+    if(!rank)
+      std::cout << "MPI_THREAD_MULTIPLE is not supported by the MPI library, skipping the test\n";
+    MPI_Finalize();
+    return 0;
+  }
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  if(argc != 3) {
+    if(!rank)
+      std::cerr << "Usage: " << argv[0] << " <1=isRendezvousApp,0=isParticipant> <rdvRanks>\n";
+    exit(EXIT_FAILURE);
+  }
+  const auto isRdv = atoi(argv[1]);
+  const auto rdvRanks = atoi(argv[2]);
+  REDEV_ALWAYS_ASSERT(!isRdv || rdvRanks == nproc);
+  {
+    //the cuts won't be used since GetRank(...) won't be called
+    const auto dim = 1;
+    auto ranks = redev::LOs(rdvRanks);
+    auto cuts = redev::Reals(rdvRanks);
+    auto ptn = redev::RCBPtn(dim, ranks, cuts);
+    redev::Redev rdv(MPI_COMM_WORLD, redev::Partition{std::move(ptn)},
+        static_cast<redev::ProcessType>(isRdv));
+    rdv.SetThreadSafe(true);
+    REDEV_ALWAYS_ASSERT(rdv.GetThreadSafe());
+    adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "12"}};
+    auto channel = rdv.CreateAdiosChannel("threadSafe", params);
+    std::vector<redev::BidirectionalComm<redev::LO>> comms;
+    for(int t=0; t<numThreads; t++)
+      comms.push_back(channel.CreateComm<redev::LO>("field" + std::to_string(t), rdv.GetMPIComm()));
+
+    for(int round=0; round<rounds; round++) {
+      std::vector<std::thread> threads;
+      if(!isRdv) {
+        redev::LOs dest{rank%rdvRanks};
+        redev::LOs offsets{0, numThreads*(rank+1)};
+        std::vector<redev::LOs> msgs(numThreads);
+        channel.BeginSendCommunicationPhase();
+        for(int t=0; t<numThreads; t++) {
+          threads.emplace_back([&, t]() {
+            REDEV_ALWAYS_ASSERT(channel.InSendCommunicationPhase());
+            msgs[t].assign(offsets.back(), value(t, rank));
+            comms[t].SetOutMessageLayout(dest, offsets);
+            comms[t].Send(msgs[t].data());
+          });
+        }
+        for(auto& thread : threads)
+          thread.join();
+        channel.EndSendCommunicationPhase();
+      } else {
+        std::vector<redev::LOs> msgs(numThreads);
+        channel.BeginReceiveCommunicationPhase();
+        for(int t=0; t<numThreads; t++) {
+          threads.emplace_back([&, t]() {
+            REDEV_ALWAYS_ASSERT(channel.InReceiveCommunicationPhase());
+            msgs[t] = comms[t].Recv(redev::Mode::Synchronous);
+          });
+        }
+        for(auto& thread : threads)
+          thread.join();
+        channel.EndReceiveCommunicationPhase();
+        for(int t=0; t<numThreads; t++) {
+          const auto in = comms[t].GetInMessageLayout();
+          const auto numSenders = in.srcRanks.size()/rdvRanks;
+          REDEV_ALWAYS_ASSERT(msgs[t].size() == in.count);
+          //sender s wrote its items at srcRanks[s*rdvRanks+rank]
+          for(size_t s=0; s<numSenders; s++) {
+            if(static_cast<int>(s)%rdvRanks != rank)
+              continue;
+            const auto start = in.srcRanks[s*rdvRanks+rank];
+            for(int i=0; i<numThreads*(static_cast<int>(s)+1); i++)
+              REDEV_ALWAYS_ASSERT(msgs[t][start+i] == value(t, s));
+          }
+        }
+      }
+    }
+  }
+  MPI_Finalize();
+  return 0;
+}
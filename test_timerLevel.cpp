@@ -0,0 +1,34 @@
+#include <iostream>
+#include <cstdlib>
+#include "redev.h"
+
+namespace {
+  //a function with a hot path timer
+  int hot(int i) {
+    REDEV_HOT_TIMER;
+    return i+1;
+  }
+  int call(int i) {
+    REDEV_FUNCTION_TIMER;
+    REDEV_PHASE_TIMER("test phase");
+    return hot(i);
+  }
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  //the runtime level starts at the compile time level unless the
+  //environment lowers it
+  if(!std::getenv("REDEV_TIMER_LEVEL"))
+    REDEV_ALWAYS_ASSERT(redev::GetTimerLevel() == REDEV_TIMER_LEVEL);
+  REDEV_ALWAYS_ASSERT(redev::GetTimerLevel() <= REDEV_TIMER_LEVEL);
+  redev::SetTimerLevel(REDEV_TIMER_LEVEL+1);
+  REDEV_ALWAYS_ASSERT(redev::GetTimerLevel() == REDEV_TIMER_LEVEL);
+  redev::SetTimerLevel(-1);
+  REDEV_ALWAYS_ASSERT(redev::GetTimerLevel() == 0);
+  REDEV_ALWAYS_ASSERT(call(1) == 2);
+  redev::SetTimerLevel(REDEV_TIMER_LEVEL);
+  REDEV_ALWAYS_ASSERT(call(2) == 3);
+  MPI_Finalize();
+  return 0;
+}
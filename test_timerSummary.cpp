@@ -0,0 +1,53 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "redev.h"
+
+namespace {
+  void work() {
+    REDEV_PHASE_TIMER("test work");
+  }
+}
+
+/**
+ * rank r runs the timer r+1 times on the main thread and once on a second
+ * thread
+ */
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  //not recorded before the summary is enabled
+  work();
+  redev::EnableTimerSummary("test_timerSummary.txt");
+  REDEV_ALWAYS_ASSERT(redev::TimerSummaryEnabled());
+  for(int i=0; i<=rank; i++)
+    work();
+  std::thread worker(work);
+  worker.join();
+  auto summary = redev::SummarizeTimers(MPI_COMM_WORLD);
+  REDEV_ALWAYS_ASSERT(summary.size() == 1);
+  REDEV_ALWAYS_ASSERT(summary[0].name == "test work");
+  const long long calls = nproc*(nproc+1)/2 + nproc;
+  REDEV_ALWAYS_ASSERT(summary[0].calls == calls);
+  REDEV_ALWAYS_ASSERT(summary[0].minSeconds <= summary[0].avgSeconds);
+  REDEV_ALWAYS_ASSERT(summary[0].avgSeconds <= summary[0].maxSeconds);
+  REDEV_ALWAYS_ASSERT(summary[0].maxRank >= 0 && summary[0].maxRank < nproc);
+  //the tables were cleared
+  REDEV_ALWAYS_ASSERT(redev::SummarizeTimers(MPI_COMM_WORLD).empty());
+  //only some ranks ran the timer
+  if(rank == nproc-1)
+    work();
+  redev::WriteTimerSummary(MPI_COMM_WORLD);
+  if(!rank) {
+    std::ifstream in("test_timerSummary.txt");
+    REDEV_ALWAYS_ASSERT(in.is_open());
+    std::stringstream ss;
+    ss << in.rdbuf();
+    REDEV_ALWAYS_ASSERT(ss.str().find("test work") != std::string::npos);
+  }
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,66 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "redev.h"
+
+namespace {
+  int countOf(const std::string& str, const std::string& sub) {
+    int n = 0;
+    for(auto pos = str.find(sub); pos != std::string::npos; pos = str.find(sub, pos+1))
+      n++;
+    return n;
+  }
+}
+
+/**
+ * each rank records more events than its ring buffer holds on the main thread
+ * and a few on a second thread, rank 0 checks that the trace file contains the
+ * most recent events of every rank and thread
+ */
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  REDEV_ALWAYS_ASSERT(!redev::trace::Enabled());
+  //disabled events are not recorded
+  { REDEV_TRACE_EVENT("disabled"); }
+  const auto capacity = 4;
+  redev::trace::Enable("test_trace", capacity);
+  REDEV_ALWAYS_ASSERT(redev::trace::Enabled());
+  for(int i=0; i<capacity-1; i++) {
+    REDEV_TRACE_EVENT("old");
+  }
+  for(int i=0; i<capacity; i++) {
+    REDEV_TRACE_EVENT("recent");
+  }
+  std::thread worker([]() {
+    REDEV_TRACE_EVENT("worker");
+  });
+  worker.join();
+  //client clock is 1ms ahead with a 2us delay each way
+  redev::trace::AddClockOffset("ch", 0, 1002000, 1010000, 12000);
+  redev::trace::Flush(MPI_COMM_WORLD, true);
+  REDEV_ALWAYS_ASSERT(!redev::trace::Enabled());
+  if(!rank) {
+    std::ifstream in("test_trace_server.json");
+    REDEV_ALWAYS_ASSERT(in.is_open());
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const auto trace = ss.str();
+    REDEV_ALWAYS_ASSERT(trace.find("\"traceEvents\"") != std::string::npos);
+    REDEV_ALWAYS_ASSERT(countOf(trace, "\"name\":\"disabled\"") == 0);
+    REDEV_ALWAYS_ASSERT(countOf(trace, "\"name\":\"old\"") == 0);
+    REDEV_ALWAYS_ASSERT(countOf(trace, "\"name\":\"recent\"") == capacity*nproc);
+    REDEV_ALWAYS_ASSERT(countOf(trace, "\"name\":\"worker\"") == nproc);
+    REDEV_ALWAYS_ASSERT(countOf(trace, "\"name\":\"process_name\"") == nproc);
+    REDEV_ALWAYS_ASSERT(countOf(trace, "\"dropped events\":3") == nproc);
+    REDEV_ALWAYS_ASSERT(trace.find("clock offset to client of channel ch (us)\":1000") != std::string::npos);
+    REDEV_ALWAYS_ASSERT(trace.find("clock offset round trip of channel ch (us)\":4") != std::string::npos);
+  }
+  //flushing again does nothing
+  redev::trace::Flush(MPI_COMM_WORLD, true);
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <cstdlib>
+#include "redev.h"
+
+/**
+ * The server sends three partitions to the client: the partition passed to
+ * the Redev constructor, an updated RCBPtn, and a GridPtn. Each update is
+ * received at the start of the receive phase that follows it. With nodeShared
+ * the client keeps the partitions in node shared memory, see
+ * redev::PartitionStorage::NodeShared.
+ */
+void updateTest(bool isRdv, bool nodeShared) {
+  const auto dim = 1;
+  auto ranks = isRdv ? redev::LOs({0,1}) : redev::LOs();
+  auto cuts = isRdv ? redev::Reals({0,0.5}) : redev::Reals();
+  redev::Redev rdv(MPI_COMM_WORLD,redev::Partition{std::in_place_type<redev::RCBPtn>,dim,ranks,cuts},static_cast<redev::ProcessType>(isRdv));
+  if(nodeShared && !isRdv)
+    rdv.SetPartitionStorage(redev::PartitionStorage::NodeShared);
+  adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "2"}};
+  auto channel = rdv.CreateAdiosChannel("foo", params,
+                                                    redev::TransportType::BP4);
+  auto commPair = channel.CreateComm<redev::LO>("foo", MPI_COMM_WORLD);
+  REDEV_ALWAYS_ASSERT(rdv.GetPartitionVersion() == 0);
+  if(isRdv) {
+    channel.SendPhase([](){});
+    ranks = redev::LOs({1,0});
+    cuts = redev::Reals({0,0.25});
+    rdv.UpdatePartition(redev::Partition{std::in_place_type<redev::RCBPtn>,dim,ranks,cuts});
+    REDEV_ALWAYS_ASSERT(rdv.GetPartitionVersion() == 1);
+    channel.SendPhase([](){});
+    rdv.UpdatePartition(redev::Partition{std::in_place_type<redev::GridPtn>, dim,
+        std::array<redev::Real,3>{0,0,0}, std::array<redev::Real,3>{0.5,1,1},
+        std::array<redev::LO,3>{2,1,1}, redev::LOs({1,0})});
+    REDEV_ALWAYS_ASSERT(rdv.GetPartitionVersion() == 2);
+    channel.SendPhase([](){});
+  } else {
+    channel.ReceivePhase([](){});
+    REDEV_ALWAYS_ASSERT(rdv.GetPartitionVersion() == 0);
+    REDEV_ALWAYS_ASSERT(std::get<redev::RCBPtn>(rdv.GetPartition()).GetCuts() == redev::Reals({0,0.5}));
+    channel.ReceivePhase([](){});
+    REDEV_ALWAYS_ASSERT(rdv.GetPartitionVersion() == 1);
+    const auto& rcb = std::get<redev::RCBPtn>(rdv.GetPartition());
+    REDEV_ALWAYS_ASSERT(rcb.GetCuts() == redev::Reals({0,0.25}));
+    REDEV_ALWAYS_ASSERT(rcb.GetRanks() == redev::LOs({1,0}));
+    channel.ReceivePhase([](){});
+    REDEV_ALWAYS_ASSERT(rdv.GetPartitionVersion() == 2);
+    const auto& grid = std::get<redev::GridPtn>(rdv.GetPartition());
+    REDEV_ALWAYS_ASSERT(grid.GetRank(std::array<redev::Real,3>{0.75,0,0}) == 0);
+    REDEV_ALWAYS_ASSERT(grid.GetRank(std::array<redev::Real,3>{0.25,0,0}) == 1);
+  }
+}
+
+int main(int argc, char** argv) {
+  int rank, nproc;
+  MPI_Init(&argc, &argv);
+  if(argc != 2 && argc != 3) {
+    std::cerr << "Usage: " << argv[0] << " <1=isRendezvousApp,0=isParticipant> [1=nodeShared]\n";
+    exit(EXIT_FAILURE);
+  }
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  auto isRdv = atoi(argv[1]);
+  auto nodeShared = argc == 3 && atoi(argv[2]) == 1;
+  updateTest(isRdv, nodeShared);
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,234 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <algorithm> //find
+#include <numeric> //iota
+#include <chrono> //steady_clock, duration
+#include <sstream>
+#include "redev.h"
+#include "util_support.h"
+
+// many client benchmark
+// One rendezvous server is coupled to numClients client applications, each
+// with its own channel, like test_twoClients but with any number of clients
+// running at the same time; launch them with runManyClientJobs.sh. In each
+// step every client sends its bytes per rank, spread uniformly over the
+// server ranks, and waits for a one value reply from each server rank. The
+// server receives from all clients, in the order they become ready, see
+// redev::ChannelSet, then replies to all clients.
+// - The server appends to <prefix>_server.csv, per step, the time of the
+//   receive phase of all clients, the time of the reply, the bytes received,
+//   and the aggregate throughput in MB/s, max time over the server ranks.
+// - Client i appends to <prefix>_client<i>.csv, per step, its step latency,
+//   from the start of its send phase to the end of its receive phase, as the
+//   min, max, and average over its ranks.
+// The first step includes variable definition and engine warm up.
+
+namespace {
+  struct Options {
+    int clientId = -1;
+    int rdvRanks = 0;
+    int numClients = 0;
+    std::vector<size_t> bytes{1ULL<<20};
+    int steps = 5;
+    std::string transport = "bp4";
+    std::string prefix = "manyClients";
+  };
+
+  void usage(const char* exe) {
+    std::cerr << "Usage: " << exe << " <clientId, -1 for the server> <rdvRanks> <numClients> [options]\n"
+              << "options, all applications must pass the same:\n"
+              << "  --bytes=1M,64K  bytes sent per client rank, client i uses entry i modulo\n"
+              << "                  the list length (default 1M)\n"
+              << "  --steps=5       (default 5)\n"
+              << "  --transport=bp4|sst (default bp4)\n"
+              << "  --csv=prefix    prefix of the CSV files (default manyClients)\n";
+  }
+
+  Options parse(int argc, char** argv) {
+    Options opts;
+    if(argc < 4)
+      throw std::invalid_argument("missing arguments");
+    opts.clientId = atoi(argv[1]);
+    opts.rdvRanks = atoi(argv[2]);
+    opts.numClients = atoi(argv[3]);
+    for(int i=4; i<argc; i++) {
+      const auto [key, value] = support::parseOption(argv[i]);
+      if(key == "bytes") opts.bytes = support::splitBytes(value);
+      else if(key == "steps") opts.steps = std::stoi(value);
+      else if(key == "transport") opts.transport = value;
+      else if(key == "csv") opts.prefix = value;
+      else throw std::invalid_argument(argv[i]);
+    }
+    return opts;
+  }
+
+  //append to path, writing the header if the file is new
+  std::ofstream openCsv(const std::string& path, const std::string& header) {
+    const bool exists = std::ifstream(path).good();
+    std::ofstream csv(path, std::ios::app);
+    REDEV_ALWAYS_ASSERT(csv.is_open());
+    if(!exists)
+      csv << header << "\n";
+    return csv;
+  }
+
+  std::string clientName(int id) {
+    return "client" + std::to_string(id);
+  }
+}
+
+void client(redev::Redev& rdv, const Options& opts, adios2::Params params,
+    redev::TransportType transportType) {
+  using Clock = std::chrono::steady_clock;
+  int rank, nproc;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  const auto name = clientName(opts.clientId);
+  auto channel = rdv.CreateAdiosChannel(name, params, transportType);
+  auto comm = channel.CreateComm<redev::LO>(name, rdv.GetMPIComm());
+  //spread the message uniformly over the server ranks
+  const auto bytes = opts.bytes[opts.clientId % opts.bytes.size()];
+  const auto count = bytes/sizeof(redev::LO);
+  redev::LOs dest(opts.rdvRanks);
+  redev::LOs offsets(opts.rdvRanks+1, 0);
+  for(int i=0; i<opts.rdvRanks; i++) {
+    dest[i] = i;
+    offsets[i+1] = static_cast<redev::LO>(count*(i+1)/opts.rdvRanks);
+  }
+  comm.SetOutMessageLayout(dest, offsets);
+  redev::LOs msgs(count, opts.clientId);
+
+  std::ofstream csv;
+  if(!rank) {
+    csv = openCsv(opts.prefix + "_" + name + ".csv",
+        "numClients,client,ranks,bytesPerRank,step,min,max,avg");
+  }
+  for(int step=0; step<opts.steps; step++) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    const auto start = Clock::now();
+    channel.SendPhase([&]() { comm.Send(msgs.data()); });
+    const auto reply = channel.ReceivePhase([&]() { return comm.Recv(); });
+    const std::chrono::duration<double> seconds = Clock::now()-start;
+    if(!rank) {
+      REDEV_ALWAYS_ASSERT(reply.size() == static_cast<size_t>(opts.rdvRanks));
+      for(const auto r : reply)
+        REDEV_ALWAYS_ASSERT(r == opts.clientId);
+    }
+    const auto time = support::minMaxAvg(seconds.count());
+    if(!rank) {
+      csv << opts.numClients << "," << opts.clientId << "," << nproc << ","
+          << bytes << "," << step << "," << time.min << "," << time.max << ","
+          << time.avg << "\n";
+    }
+  }
+}
+
+void server(redev::Redev& rdv, const Options& opts, adios2::Params params,
+    redev::TransportType transportType) {
+  using Clock = std::chrono::steady_clock;
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  std::vector<redev::Channel> channels;
+  std::vector<redev::BidirectionalComm<redev::LO>> comms;
+  for(int i=0; i<opts.numClients; i++) {
+    channels.push_back(rdv.CreateAdiosChannel(clientName(i), params, transportType));
+    comms.push_back(channels.back().CreateComm<redev::LO>(clientName(i), rdv.GetMPIComm()));
+  }
+  redev::ChannelSet set(rdv.GetMPIComm());
+  for(auto& channel : channels)
+    set.Add(channel);
+  //reply with one value to rank 0 of each client
+  redev::LOs dest{0};
+  redev::LOs offsets{0, 1};
+  for(auto& comm : comms)
+    comm.SetOutMessageLayout(dest, offsets);
+
+  std::ofstream csv;
+  if(!rank) {
+    csv = openCsv(opts.prefix + "_server.csv",
+        "numClients,step,recvSeconds,replySeconds,bytes,throughputMBps");
+  }
+  for(int step=0; step<opts.steps; step++) {
+    const auto start = Clock::now();
+    //receive from the clients in the order they become ready
+    std::vector<size_t> pending(opts.numClients);
+    std::iota(pending.begin(), pending.end(), 0);
+    size_t bytes = 0;
+    while(!pending.empty()) {
+      const auto i = *set.WaitAny(pending);
+      //the deferred Get fills msgs at EndStep, keep it alive until then
+      const auto msgs = comms[i].Recv();
+      channels[i].EndReceiveCommunicationPhase();
+      bytes += msgs.size()*sizeof(redev::LO);
+      pending.erase(std::find(pending.begin(), pending.end(), i));
+    }
+    const auto recvEnd = Clock::now();
+    //the deferred Puts read the replies at EndStep
+    std::vector<redev::LOs> replies;
+    for(auto& channel : channels)
+      channel.BeginSendCommunicationPhase();
+    for(int i=0; i<opts.numClients; i++)
+      replies.emplace_back(1, i);
+    for(int i=0; i<opts.numClients; i++)
+      comms[i].Send(replies[i].data());
+    for(auto& channel : channels)
+      channel.EndSendCommunicationPhase();
+    const auto end = Clock::now();
+    const auto recvSeconds = support::minMaxAvg(
+        std::chrono::duration<double>(recvEnd-start).count()).max;
+    const auto replySeconds = support::minMaxAvg(
+        std::chrono::duration<double>(end-recvEnd).count()).max;
+    unsigned long long totBytes = 0;
+    const unsigned long long localBytes = bytes;
+    MPI_Allreduce(&localBytes, &totBytes, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if(!rank) {
+      csv << opts.numClients << "," << step << "," << recvSeconds << ","
+          << replySeconds << "," << totBytes << ","
+          << totBytes/recvSeconds/(1024*1024) << "\n";
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int rank, nproc;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  Options opts;
+  try {
+    opts = parse(argc, argv);
+  } catch(const std::exception& e) {
+    if(!rank) {
+      std::cerr << "Error: " << e.what() << "\n";
+      usage(argv[0]);
+    }
+    exit(EXIT_FAILURE);
+  }
+  const auto isRdv = opts.clientId == -1;
+  REDEV_ALWAYS_ASSERT(opts.numClients > 0);
+  REDEV_ALWAYS_ASSERT(opts.clientId >= -1 && opts.clientId < opts.numClients);
+  REDEV_ALWAYS_ASSERT(opts.rdvRanks > 0);
+  REDEV_ALWAYS_ASSERT(!isRdv || opts.rdvRanks == nproc);
+  REDEV_ALWAYS_ASSERT(opts.steps > 0);
+  const auto transportType = opts.transport == "sst" ?
+    redev::TransportType::SST : redev::TransportType::BP4;
+  adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "60"}};
+  {
+    if(!isRdv) {
+      redev::Redev rdv(MPI_COMM_WORLD, redev::ProcessType::Client);
+      client(rdv, opts, params, transportType);
+    } else {
+      //dummy partition, the layouts are set without GetRank(...)
+      const auto dim = 1;
+      auto ranks = redev::LOs({0});
+      auto cuts = redev::Reals({0});
+      auto ptn = redev::RCBPtn(dim, ranks, cuts);
+      redev::Redev rdv(MPI_COMM_WORLD, redev::Partition{std::move(ptn)},
+          redev::ProcessType::Server);
+      server(rdv, opts, params, transportType);
+    }
+  }
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,296 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono> //steady_clock, duration
+#include <limits>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "redev.h"
+#include "util_support.h"
+
+// partition query microbenchmark
+// Single process benchmark of the owner lookups called once per mesh entity
+// by the clients. For each configuration each of <threads> threads queries
+// the same read-only set of points or model entities and one CSV row is
+// written with the best of <repeats> runs:
+// - rcbPoint: RCBPtn::GetRank(std::array) per point
+// - rcbBatch: RCBPtn::GetRank(redev::Reals) on all points
+// - class: ClassPtn::GetRank per model entity
+// The RCB trees are balanced bisections of the unit cube with 2^depth leaves
+// in 2D or 3D. The ClassPtn tables have <size> dimension 2 entities with ids
+// 0 to size-1 (dense) or spread over the LO range (sparse). The queries are
+// - random: uniform over the domain or the table
+// - sorted: the random queries sorted, as when the mesh is traversed in
+//   spatial or id order
+// - clustered: uniform within 16 small regions of the domain or the table,
+//   as for a client that owns a few sub-domains
+// The nsPerQuery and queriesPerSecPerThread columns are per thread, from the
+// slowest thread; queriesPerSec is the total over the threads. Build with
+// REDEV_TIMER_LEVEL at most 2 or set the REDEV_TIMER_LEVEL environment
+// variable to 2 or less, otherwise the per query timers are measured too.
+
+namespace {
+  struct Options {
+    long queries = 1000000;
+    std::vector<long> threads{1};
+    std::vector<long> dims{2, 3};
+    std::vector<long> depths{1, 4, 8, 12, 16};
+    std::vector<long> classSizes{10, 1000, 100000, 10000000};
+    std::vector<std::string> dists{"random", "sorted", "clustered"};
+    std::vector<std::string> kernels{"rcbPoint", "rcbBatch", "class"};
+    int repeats = 5;
+    std::string csv;
+  };
+
+  void usage(const char* exe) {
+    std::cerr << "Usage: " << exe << " [options]\n"
+              << "options, lists are comma separated:\n"
+              << "  --queries=1000000              queries per thread\n"
+              << "  --threads=1,2,4                (default 1)\n"
+              << "  --dims=2,3                     RCBPtn dimensions (default 2,3)\n"
+              << "  --depths=1,4,8,12,16           RCBPtn depths, 2^depth leaves\n"
+              << "  --classSizes=10,1000,100000,10000000 ClassPtn entity counts\n"
+              << "  --dists=random,sorted,clustered\n"
+              << "  --kernels=rcbPoint,rcbBatch,class\n"
+              << "  --repeats=5                    runs per configuration, the best is reported\n"
+              << "  --csv=file                     write the rows to file instead of stdout\n";
+  }
+
+  Options parse(int argc, char** argv) {
+    Options opts;
+    for(int i=1; i<argc; i++) {
+      const auto [key, value] = support::parseOption(argv[i]);
+      if(key == "queries") opts.queries = std::stol(value);
+      else if(key == "threads") opts.threads = support::splitInts<long>(value);
+      else if(key == "dims") opts.dims = support::splitInts<long>(value);
+      else if(key == "depths") opts.depths = support::splitInts<long>(value);
+      else if(key == "classSizes") opts.classSizes = support::splitInts<long>(value);
+      else if(key == "dists") opts.dists = support::split(value);
+      else if(key == "kernels") opts.kernels = support::split(value);
+      else if(key == "repeats") opts.repeats = std::stoi(value);
+      else if(key == "csv") opts.csv = value;
+      else throw std::invalid_argument(argv[i]);
+    }
+    return opts;
+  }
+
+  //balanced bisection of the unit cube, the cut of each node is at the
+  //middle of its box along axis level%dim
+  redev::RCBPtn makeRcb(int dim, int depth) {
+    const size_t leaves = size_t(1) << depth;
+    std::vector<int> ranks(leaves);
+    std::vector<double> cuts(leaves, 0);
+    for(size_t i=0; i<leaves; i++)
+      ranks[i] = static_cast<int>(i);
+    std::vector<std::array<double,6>> boxes(leaves); //lower and upper corners
+    if(leaves > 1)
+      boxes[1] = {0,0,0,1,1,1};
+    for(size_t idx=1; idx<leaves; idx++) {
+      int lvl = 0;
+      while((size_t(2) << lvl) <= idx) lvl++;
+      const auto d = lvl % dim;
+      const auto& box = boxes[idx];
+      cuts[idx] = (box[d] + box[3+d]) / 2;
+      if(2*idx < leaves) {
+        boxes[2*idx] = boxes[2*idx+1] = box;
+        boxes[2*idx][3+d] = cuts[idx];
+        boxes[2*idx+1][d] = cuts[idx];
+      }
+    }
+    return redev::RCBPtn(dim, ranks, cuts);
+  }
+
+  //(x0,y0,z0,x1,y1,z1,...) in the unit cube
+  redev::Reals makePoints(long n, const std::string& dist, std::mt19937_64& gen) {
+    std::uniform_real_distribution<double> unit(0, 1);
+    redev::Reals pts(3*n);
+    if(dist == "random" || dist == "sorted") {
+      for(auto& x : pts)
+        x = unit(gen);
+      if(dist == "sorted") {
+        std::vector<std::array<double,3>> sorted(n);
+        for(long i=0; i<n; i++)
+          sorted[i] = {pts[3*i], pts[3*i+1], pts[3*i+2]};
+        std::sort(sorted.begin(), sorted.end());
+        for(long i=0; i<n; i++)
+          std::copy(sorted[i].begin(), sorted[i].end(), &pts[3*i]);
+      }
+    } else if(dist == "clustered") {
+      const int numClusters = 16;
+      const double width = 0.02;
+      std::vector<std::array<double,3>> centers(numClusters);
+      for(auto& c : centers)
+        for(auto& x : c)
+          x = width + (1-2*width)*unit(gen);
+      std::uniform_int_distribution<int> cluster(0, numClusters-1);
+      std::uniform_real_distribution<double> offset(-width, width);
+      for(long i=0; i<n; i++) {
+        const auto& c = centers[cluster(gen)];
+        for(int d=0; d<3; d++)
+          pts[3*i+d] = c[d] + offset(gen);
+      }
+    } else {
+      throw std::invalid_argument("unknown distribution " + dist);
+    }
+    return pts;
+  }
+
+  redev::ClassPtn makeClass(long size, bool sparse, redev::ClassPtn::ModelEntVec& ents) {
+    const redev::LO stride = sparse ? std::numeric_limits<redev::LO>::max()/size : 1;
+    ents.resize(size);
+    redev::LOs ranks(size);
+    for(long i=0; i<size; i++) {
+      ents[i] = {2, static_cast<redev::LO>(i*stride)};
+      ranks[i] = static_cast<redev::LO>(i % 1024);
+    }
+    return redev::ClassPtn(MPI_COMM_SELF, ranks, ents);
+  }
+
+  //indices into the table of size entities
+  std::vector<long> makeIndices(long n, long size, const std::string& dist,
+      std::mt19937_64& gen) {
+    std::vector<long> idx(n);
+    if(dist == "random" || dist == "sorted") {
+      std::uniform_int_distribution<long> any(0, size-1);
+      for(auto& i : idx)
+        i = any(gen);
+      if(dist == "sorted")
+        std::sort(idx.begin(), idx.end());
+    } else if(dist == "clustered") {
+      const long numClusters = 16;
+      const long width = std::max(1L, std::min(1024L, size/numClusters));
+      std::uniform_int_distribution<long> start(0, size-width);
+      std::vector<long> starts(numClusters);
+      for(auto& s : starts)
+        s = start(gen);
+      std::uniform_int_distribution<long> cluster(0, numClusters-1);
+      std::uniform_int_distribution<long> offset(0, width-1);
+      for(auto& i : idx)
+        i = starts[cluster(gen)] + offset(gen);
+    } else {
+      throw std::invalid_argument("unknown distribution " + dist);
+    }
+    return idx;
+  }
+
+  //run the query function on each thread and return the time of the slowest
+  //thread of the best run
+  template <typename Query>
+  double bestTime(int numThreads, int repeats, Query query) {
+    using Clock = std::chrono::steady_clock;
+    double best = std::numeric_limits<double>::max();
+    std::atomic<long> checksum{0};
+    for(int r=0; r<repeats; r++) {
+      std::vector<double> seconds(numThreads);
+      std::vector<std::thread> threads;
+      std::atomic<int> ready{0};
+      for(int t=0; t<numThreads; t++) {
+        threads.emplace_back([&, t]() {
+          ready++;
+          while(ready.load() < numThreads) {} //start together
+          const auto start = Clock::now();
+          checksum += query();
+          seconds[t] = std::chrono::duration<double>(Clock::now()-start).count();
+        });
+      }
+      for(auto& t : threads)
+        t.join();
+      best = std::min(best, *std::max_element(seconds.begin(), seconds.end()));
+    }
+    if(checksum.load() == -1) //keeps the queries from being optimized away
+      std::cerr << "checksum " << checksum.load() << "\n";
+    return best;
+  }
+
+  void writeRow(std::ostream& os, const std::string& config, long queries,
+      int threads, double seconds) {
+    const double perThread = queries/seconds;
+    os << config << "," << threads << "," << queries << ","
+       << 1e9*seconds/queries << "," << perThread << "," << perThread*threads << "\n";
+  }
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  Options opts;
+  try {
+    opts = parse(argc, argv);
+  } catch(const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    usage(argv[0]);
+    exit(EXIT_FAILURE);
+  }
+  REDEV_ALWAYS_ASSERT(opts.queries > 0);
+  REDEV_ALWAYS_ASSERT(opts.repeats > 0);
+  std::ofstream csvFile;
+  if(!opts.csv.empty())
+    csvFile.open(opts.csv);
+  std::ostream& csv = opts.csv.empty() ? std::cout : csvFile;
+  csv << "kernel,dim,size,ids,dist,threads,queries,nsPerQuery,queriesPerSecPerThread,queriesPerSec\n";
+  std::mt19937_64 gen(42);
+  const auto has = [&](const std::string& kernel) {
+    return std::find(opts.kernels.begin(), opts.kernels.end(), kernel) != opts.kernels.end();
+  };
+
+  for(const auto dim : opts.dims) {
+    for(const auto depth : opts.depths) {
+      const auto ptn = makeRcb(static_cast<int>(dim), static_cast<int>(depth));
+      for(const auto& dist : opts.dists) {
+        const auto pts = makePoints(opts.queries, dist, gen);
+        for(const auto numThreads : opts.threads) {
+          std::stringstream ss;
+          ss << dim << "," << (1L << depth) << ",," << dist;
+          if(has("rcbPoint")) {
+            const auto seconds = bestTime(numThreads, opts.repeats, [&]() {
+              long sum = 0;
+              for(size_t i=0; i<pts.size(); i+=3) {
+                std::array<redev::Real,3> pt{pts[i], pts[i+1], pts[i+2]};
+                sum += ptn.GetRank(pt);
+              }
+              return sum;
+            });
+            writeRow(csv, "rcbPoint," + ss.str(), opts.queries, numThreads, seconds);
+          }
+          if(has("rcbBatch")) {
+            const auto seconds = bestTime(numThreads, opts.repeats, [&]() {
+              const auto owners = ptn.GetRank(pts);
+              return static_cast<long>(owners.back());
+            });
+            writeRow(csv, "rcbBatch," + ss.str(), opts.queries, numThreads, seconds);
+          }
+        }
+      }
+    }
+  }
+
+  if(has("class")) {
+    for(const auto size : opts.classSizes) {
+      for(const bool sparse : {false, true}) {
+        redev::ClassPtn::ModelEntVec ents;
+        const auto ptn = makeClass(size, sparse, ents);
+        for(const auto& dist : opts.dists) {
+          const auto idx = makeIndices(opts.queries, size, dist, gen);
+          redev::ClassPtn::ModelEntVec queries(idx.size());
+          for(size_t i=0; i<idx.size(); i++)
+            queries[i] = ents[idx[i]];
+          for(const auto numThreads : opts.threads) {
+            const auto seconds = bestTime(numThreads, opts.repeats, [&]() {
+              long sum = 0;
+              for(const auto& ent : queries)
+                sum += ptn.GetRank(ent);
+              return sum;
+            });
+            std::stringstream ss;
+            ss << "class,," << size << "," << (sparse ? "sparse" : "dense") << "," << dist;
+            writeRow(csv, ss.str(), opts.queries, numThreads, seconds);
+          }
+        }
+      }
+    }
+  }
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,232 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <chrono> //steady_clock, duration
+#include <limits>
+#include <sstream>
+#include <tuple> //ignore
+#include "redev.h"
+#include "util_support.h"
+
+// channel setup benchmark
+// For each partition type and size and each number of channels the
+// rendezvous and non-rendezvous applications repeatedly
+// - construct the partition (rendezvous application only)
+// - construct the Redev object
+// - create the channels, opening their engines and exchanging the partition
+//   and communicator sizes
+// - create one BidirectionalComm per channel
+// and write one CSV row per repetition and stage with the min, max, and
+// average over the ranks of the application. The wall time stages are
+// partition, redev, channels, comms, and total. The channel setup is further
+// split with the built-in timer summary, see redev_profile.h, into the
+// inclusive time, summed over the channels, of opening the engines, waiting
+// for the BP4 files, and each metadata step; this requires a timer level of
+// at least 2. Run the applications with different rank counts to measure the
+// dependence on them; the ranks column records the size of each application.
+//
+// The partitions:
+// - class: ClassPtn with <size> model entities assigned round robin, the ids
+//   are 0 to size-1 (dense) or spread over the LO range (sparse)
+// - rcb: RCBPtn with depth <size>, 2^size leaves assigned round robin
+
+namespace {
+  struct Options {
+    bool isRdv = false;
+    std::string transport = "bp4";
+    std::vector<std::string> ptns{"class", "rcb"};
+    std::vector<int> classSizes{10, 100000};
+    std::vector<int> rcbDepths{2, 10};
+    bool sparse = false;
+    std::vector<int> channels{1, 4};
+    int repeats = 3;
+    std::string csv;
+  };
+
+  void usage(const char* exe) {
+    std::cerr << "Usage: " << exe << " <1=isRendezvousApp,0=isParticipant> [options]\n"
+              << "options, lists are comma separated, both applications must pass the same:\n"
+              << "  --transport=bp4|sst     (default bp4)\n"
+              << "  --ptns=class,rcb        (default class,rcb)\n"
+              << "  --classSizes=10,100000  ClassPtn entity counts (default 10,100000)\n"
+              << "  --rcbDepths=2,10        RCBPtn depths (default 2,10)\n"
+              << "  --sparse=0|1            sparse ClassPtn ids (default 0)\n"
+              << "  --channels=1,4          channels per Redev object (default 1,4)\n"
+              << "  --repeats=3             repetitions per configuration (default 3)\n"
+              << "  --csv=file              write the rows to file instead of stdout\n";
+  }
+
+  Options parse(int argc, char** argv) {
+    Options opts;
+    if(argc < 2)
+      throw std::invalid_argument("missing arguments");
+    opts.isRdv = atoi(argv[1]);
+    for(int i=2; i<argc; i++) {
+      const auto [key, value] = support::parseOption(argv[i]);
+      if(key == "transport") opts.transport = value;
+      else if(key == "ptns") opts.ptns = support::split(value);
+      else if(key == "classSizes") opts.classSizes = support::splitInts(value);
+      else if(key == "rcbDepths") opts.rcbDepths = support::splitInts(value);
+      else if(key == "sparse") opts.sparse = std::stoi(value);
+      else if(key == "channels") opts.channels = support::splitInts(value);
+      else if(key == "repeats") opts.repeats = std::stoi(value);
+      else if(key == "csv") opts.csv = value;
+      else throw std::invalid_argument(argv[i]);
+    }
+    return opts;
+  }
+
+  redev::Partition makePartition(const std::string& type, int size, bool sparse) {
+    int rank, nproc;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+    REDEV_ALWAYS_ASSERT(size > 0);
+    if(type == "class") {
+      //each rank passes the entities it owns
+      const redev::LO stride = sparse ? std::numeric_limits<redev::LO>::max()/size : 1;
+      redev::LOs ranks;
+      redev::ClassPtn::ModelEntVec ents;
+      for(int i=rank; i<size; i+=nproc) {
+        ranks.push_back(rank);
+        ents.push_back({2, i*stride});
+      }
+      return redev::Partition{std::in_place_type<redev::ClassPtn>,
+          MPI_COMM_WORLD, ranks, ents};
+    } else if(type == "rcb") {
+      //rank 0 passes the tree, heap ordered, cuts[0] is not used
+      const auto dim = 3;
+      const auto leaves = 1 << size;
+      std::vector<int> ranks(rank ? 0 : leaves);
+      std::vector<double> cuts(rank ? 0 : leaves);
+      for(int i=0; i<static_cast<int>(ranks.size()); i++) {
+        ranks[i] = i % nproc;
+        cuts[i] = 0.5;
+      }
+      auto ptn = redev::RCBPtn(dim, ranks, cuts);
+      ptn.Broadcast(MPI_COMM_WORLD);
+      return redev::Partition{std::move(ptn)};
+    }
+    throw std::invalid_argument("unknown partition " + type);
+  }
+
+  void writeRow(std::ostream& os, const std::string& config, int repeat,
+      const std::string& stage, double min, double max, double avg) {
+    os << config << "," << repeat << "," << stage << ","
+       << min << "," << max << "," << avg << "\n";
+  }
+
+  //the setup stages and the timed functions they are reported from
+  const std::vector<std::pair<std::string, std::string>> setupStages{
+    {"open engines", "::openEngines"},
+    {"wait for engine creation", "waitForEngineCreation("},
+    {"metadata steps", "AdiosChannel::Setup("},
+    {"partition type", "::SendPartitionTypeToClient("},
+    {"version check", "::CheckVersion("},
+    {"partition write", "::WritePartition("},
+    {"partition read", "::ReadPartition("},
+    {"partition broadcast", "::BroadcastPartition("},
+    {"server comm size", "::SendServerCommSizeToClient("},
+    {"client comm size", "::SendClientCommSizeToServer("}
+  };
+
+  void writeStages(std::ostream& os, const std::string& config, int repeat,
+      const std::vector<redev::TimerSummary>& timers) {
+    for(const auto& [stage, function] : setupStages) {
+      for(const auto& t : timers) {
+        if(t.name.find(function) != std::string::npos)
+          writeRow(os, config, repeat, stage, t.minSeconds, t.maxSeconds, t.avgSeconds);
+      }
+    }
+  }
+}
+
+void setup(const Options& opts, const std::string& ptnType, int ptnSize,
+    int numChannels, int& config, std::ostream& csv) {
+  using Clock = std::chrono::steady_clock;
+  using Seconds = std::chrono::duration<double>;
+  int rank, nproc;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  const auto transportType = opts.transport == "sst" ?
+    redev::TransportType::SST : redev::TransportType::BP4;
+  std::stringstream ss;
+  ss << (opts.isRdv ? "rdv" : "app") << "," << nproc << "," << opts.transport
+     << "," << ptnType << "," << ptnSize << "," << numChannels;
+  for(int repeat=0; repeat<opts.repeats; repeat++) {
+    std::ignore = redev::SummarizeTimers(MPI_COMM_WORLD); //discard earlier calls
+    redev::EnableTimerSummary();
+    MPI_Barrier(MPI_COMM_WORLD);
+    const auto start = Clock::now();
+    //the non-rendezvous application receives the partition from the channel
+    auto ptn = opts.isRdv ? makePartition(ptnType, ptnSize, opts.sparse) : redev::Partition{};
+    const auto ptnEnd = Clock::now();
+    redev::Redev rdv(MPI_COMM_WORLD, std::move(ptn),
+        static_cast<redev::ProcessType>(opts.isRdv));
+    const auto rdvEnd = Clock::now();
+    adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "60"}};
+    std::vector<redev::Channel> channels;
+    for(int i=0; i<numChannels; i++) {
+      const auto name = "setup" + std::to_string(config) + "_" + std::to_string(i);
+      channels.push_back(rdv.CreateAdiosChannel(name, params, transportType));
+    }
+    const auto channelsEnd = Clock::now();
+    std::vector<redev::BidirectionalComm<redev::LO>> comms;
+    for(auto& channel : channels)
+      comms.push_back(channel.CreateComm<redev::LO>("msgs", rdv.GetMPIComm()));
+    const auto end = Clock::now();
+    redev::DisableTimerSummary();
+    config++;
+
+    const auto timers = redev::SummarizeTimers(MPI_COMM_WORLD);
+    const std::vector<std::pair<std::string, double>> stages{
+      {"partition", Seconds(ptnEnd-start).count()},
+      {"redev", Seconds(rdvEnd-ptnEnd).count()},
+      {"channels", Seconds(channelsEnd-rdvEnd).count()},
+      {"comms", Seconds(end-channelsEnd).count()},
+      {"total", Seconds(end-start).count()}
+    };
+    for(const auto& [stage, seconds] : stages) {
+      const auto s = support::minMaxAvg(seconds);
+      if(!rank)
+        writeRow(csv, ss.str(), repeat, stage, s.min, s.max, s.avg);
+    }
+    if(!rank)
+      writeStages(csv, ss.str(), repeat, timers);
+  }
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  Options opts;
+  try {
+    opts = parse(argc, argv);
+  } catch(const std::exception& e) {
+    if(!rank) {
+      std::cerr << "Error: " << e.what() << "\n";
+      usage(argv[0]);
+    }
+    exit(EXIT_FAILURE);
+  }
+  REDEV_ALWAYS_ASSERT(opts.repeats > 0);
+  if(!rank && redev::GetTimerLevel() < 2)
+    std::cerr << "Warning: the timer level is below 2, only the wall time stages are reported\n";
+  std::ofstream csvFile;
+  if(!rank && !opts.csv.empty())
+    csvFile.open(opts.csv);
+  std::ostream& csv = opts.csv.empty() ? std::cout : csvFile;
+  if(!rank)
+    csv << "app,ranks,transport,ptn,ptnSize,channels,repeat,stage,min,max,avg\n";
+
+  int config = 0;
+  for(const auto& ptnType : opts.ptns) {
+    const auto& sizes = ptnType == "rcb" ? opts.rcbDepths : opts.classSizes;
+    for(const auto size : sizes) {
+      for(const auto numChannels : opts.channels)
+        setup(opts, ptnType, size, numChannels, config, csv);
+    }
+  }
+  MPI_Finalize();
+  return 0;
+}
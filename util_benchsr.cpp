@@ -51,10 +51,8 @@ void sendRecvRdv(MPI_Comm mpiComm, const bool isRdv, const int mbpr, const int r
   const auto dim = 2;
   //hard coding the number of rdv ranks to 32 for now....
   if(isRdv) assert(rdvRanks == nproc);
-  auto ranks = redev::LOs(rdvRanks);
   //the cuts won't be used since getRank(...) won't be called
-  auto cuts = redev::Reals(rdvRanks);
-  auto ptn = redev::RCBPtn(dim,ranks,cuts);
+  auto ptn = support::placeholderRCBPtn(dim,rdvRanks);
   redev::Redev rdv(mpiComm,redev::Partition{std::move(ptn)},static_cast<redev::ProcessType>(isRdv));
   std::string name = "foo";
   std::stringstream ss;
@@ -101,9 +99,7 @@ void sendRecvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr, const in
   assert(nproc == rdvRanks);
   //using Redev to create engine objects...
   const auto dim = 2;
-  auto ranks = redev::LOs(rdvRanks);
-  auto cuts = redev::Reals(rdvRanks);
-  auto ptn = redev::RCBPtn(dim,ranks,cuts);
+  auto ptn = support::placeholderRCBPtn(dim,rdvRanks);
   redev::Redev rdv(mpiComm,std::move(ptn),static_cast<redev::ProcessType>(isRdv));
   //get adios objs
   std::string name = "mapped";
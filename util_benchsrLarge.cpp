@@ -1,6 +1,8 @@
 #include <iostream>
 #include <cstdlib>
 #include <cassert>
+#include <climits> //INT_MAX
+#include <numeric> //accumulate, iota
 #include <chrono> //steady_clock, duration
 #include <thread> //this_thread
 #include "redev.h"
@@ -23,6 +25,14 @@
 //     is uniformly divided across the rendezvous ranks.  This is nearly a
 //     worse case pattern resulting from minimal or poor application and
 //     rendezvous partition alignment.
+// - MPI baseline
+//   - When launched as a single MPI job the ranks are split into the
+//     non-rendezvous and rendezvous applications, the three patterns above
+//     run on the split communicators, and the Mapped and FanOut patterns are
+//     repeated with MPI_Alltoallv and MPI_Neighbor_alltoallv across both
+//     applications. The ratio of the time of each pattern to the time of the
+//     MPI implementation of the same data movement is the overhead of
+//     redev/ADIOS2 over the network.
 
 void constructCsrOffsetsFanOut(int tot, int rdvRanks, std::vector<int>& offsets) {
   //produces an uniform distribution of values
@@ -41,8 +51,7 @@ void constructCsrOffsetsMapped(int destRank, int tot, std::vector<int>& offsets)
   offsets[1] = tot;
 }
 
-void timeMinMaxAvg(double time, double& min, double& max, double& avg) {
-  const auto comm = MPI_COMM_WORLD;
+void timeMinMaxAvg(MPI_Comm comm, double time, double& min, double& max, double& avg) {
   int nproc;
   MPI_Comm_size(comm, &nproc);
   double tot = 0;
@@ -57,7 +66,8 @@ void printTime(std::string mode, double min, double max, double avg) {
             << min << " " << max << " " << avg << "\n";
 }
 
-void sendRecvRdvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
+//returns the time of the last send or receive phase
+double sendRecvRdvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
     const int rdvRanks, const int reductionFactor) {
   int rank, nproc;
   MPI_Comm_rank(mpiComm, &rank);
@@ -71,10 +81,8 @@ void sendRecvRdvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
   const auto dim = 2;
   //hard coding the number of rdv ranks to 32 for now....
   if(isRdv) assert(rdvRanks == nproc);
-  auto ranks = redev::LOs(rdvRanks);
   //the cuts won't be used since getRank(...) won't be called
-  auto cuts = redev::Reals(rdvRanks);
-  auto ptn = redev::RCBPtn(dim,ranks,cuts);
+  auto ptn = support::placeholderRCBPtn(dim,rdvRanks);
   redev::Redev rdv(mpiComm,redev::Partition{std::move(ptn)},static_cast<redev::ProcessType>(isRdv));
   std::string name = "rendezvous";
   std::stringstream ss;
@@ -83,6 +91,7 @@ void sendRecvRdvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
   auto channel = rdv.CreateAdiosChannel(name, params,
                                                     redev::TransportType::BP4);
   auto commPair = channel.CreateComm<redev::LO>(name, rdv.GetMPIComm());
+  double elapsed = 0;
   // the non-rendezvous app sends to the rendezvous app
   for(int i=0; i<3; i++) {
     if(!isRdv) {
@@ -96,29 +105,33 @@ void sendRecvRdvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
       }
       redev::LOs msgs(mbpr,rank);
       auto start = std::chrono::steady_clock::now();
-      commPair.Send(msgs.data());
+      channel.SendPhase([&]() { commPair.Send(msgs.data()); });
       auto end = std::chrono::steady_clock::now();
       std::chrono::duration<double> elapsed_seconds = end-start;
+      elapsed = elapsed_seconds.count();
       double min, max, avg;
-      timeMinMaxAvg(elapsed_seconds.count(), min, max, avg);
+      timeMinMaxAvg(mpiComm, elapsed_seconds.count(), min, max, avg);
       if( i == 0 ) ss << "write";
       std::string str = ss.str();
       if(!rank) printTime(str, min, max, avg);
     } else {
       auto start = std::chrono::steady_clock::now();
-      auto msgs = commPair.Recv();
+      const auto msgs = channel.ReceivePhase([&]() { return commPair.Recv(); });
       auto end = std::chrono::steady_clock::now();
       std::chrono::duration<double> elapsed_seconds = end-start;
+      elapsed = elapsed_seconds.count();
       double min, max, avg;
-      timeMinMaxAvg(elapsed_seconds.count(), min, max, avg);
+      timeMinMaxAvg(mpiComm, elapsed_seconds.count(), min, max, avg);
       if( i == 0 ) ss << "read";
       std::string str = ss.str();
       if(!rank) printTime(str, min, max, avg);
     }
   }
+  return elapsed;
 }
 
-void sendRecvRdvFanOut(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
+//returns the time of the last send or receive phase
+double sendRecvRdvFanOut(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
     const int rdvRanks, const int reductionFactor) {
   int rank, nproc;
   MPI_Comm_rank(mpiComm, &rank);
@@ -132,10 +145,8 @@ void sendRecvRdvFanOut(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
   const auto dim = 2;
   //hard coding the number of rdv ranks to 32 for now....
   if(isRdv) assert(rdvRanks == nproc);
-  auto ranks = redev::LOs(rdvRanks);
   //the cuts won't be used since getRank(...) won't be called
-  auto cuts = redev::Reals(rdvRanks);
-  auto ptn = redev::RCBPtn(dim,ranks,cuts);
+  auto ptn = support::placeholderRCBPtn(dim,rdvRanks);
   redev::Redev rdv(mpiComm,ptn,static_cast<redev::ProcessType>(isRdv));
   std::string name = "rendezvous";
   std::stringstream ss;
@@ -144,6 +155,7 @@ void sendRecvRdvFanOut(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
   auto channel = rdv.CreateAdiosChannel(name, params,
                                                     redev::TransportType::BP4);
   auto commPair = channel.CreateComm<redev::LO>(name, rdv.GetMPIComm());
+  double elapsed = 0;
   // the non-rendezvous app sends to the rendezvous app
   for(int i=0; i<3; i++) {
     if(!isRdv) {
@@ -157,29 +169,33 @@ void sendRecvRdvFanOut(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
       }
       redev::LOs msgs(mbpr,rank);
       auto start = std::chrono::steady_clock::now();
-      commPair.Send(msgs.data());
+      channel.SendPhase([&]() { commPair.Send(msgs.data()); });
       auto end = std::chrono::steady_clock::now();
       std::chrono::duration<double> elapsed_seconds = end-start;
+      elapsed = elapsed_seconds.count();
       double min, max, avg;
-      timeMinMaxAvg(elapsed_seconds.count(), min, max, avg);
+      timeMinMaxAvg(mpiComm, elapsed_seconds.count(), min, max, avg);
       if( i == 0 ) ss << "write";
       std::string str = ss.str();
       if(!rank) printTime(str, min, max, avg);
     } else {
       auto start = std::chrono::steady_clock::now();
-      commPair.Recv();
+      const auto msgs = channel.ReceivePhase([&]() { return commPair.Recv(); });
       auto end = std::chrono::steady_clock::now();
       std::chrono::duration<double> elapsed_seconds = end-start;
+      elapsed = elapsed_seconds.count();
       double min, max, avg;
-      timeMinMaxAvg(elapsed_seconds.count(), min, max, avg);
+      timeMinMaxAvg(mpiComm, elapsed_seconds.count(), min, max, avg);
       if( i == 0 ) ss << "read";
       std::string str = ss.str();
       if(!rank) printTime(str, min, max, avg);
     }
   }
+  return elapsed;
 }
 
-void sendRecvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
+//returns the time of the send or receive
+double sendRecvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
     const int rdvRanks, const int reductionFactor,
     const bool isSST, adios2::Params params) {
   int rank, nproc;
@@ -192,9 +208,7 @@ void sendRecvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
   }
   //using Redev to create engine objects...
   const auto dim = 2;
-  auto ranks = redev::LOs(rdvRanks);
-  auto cuts = redev::Reals(rdvRanks);
-  auto ptn = redev::RCBPtn(dim,ranks,cuts);
+  auto ptn = support::placeholderRCBPtn(dim,rdvRanks);
   redev::Redev rdv(mpiComm,std::move(ptn),static_cast<redev::ProcessType>(isRdv));
   //get adios objs
   std::string name = "mapped";
@@ -211,6 +225,7 @@ void sendRecvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
 
   std::stringstream ss;
   ss << mbpr << " B " << name;
+  double elapsed = 0;
   if(!isRdv) { //sender
     adios2::Dims shape{static_cast<size_t>(mbpr)*nproc};
     adios2::Dims start{static_cast<size_t>(mbpr)*rank};
@@ -225,8 +240,9 @@ void sendRecvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
     eng.EndStep();
     auto tEnd = std::chrono::steady_clock::now();
     std::chrono::duration<double> elapsed_seconds = tEnd-tStart;
+    elapsed = elapsed_seconds.count();
     double min, max, avg;
-    timeMinMaxAvg(elapsed_seconds.count(), min, max, avg);
+    timeMinMaxAvg(mpiComm, elapsed_seconds.count(), min, max, avg);
     ss << " write";
     std::string str = ss.str();
     if(!rank) printTime(str, min, max, avg);
@@ -246,12 +262,143 @@ void sendRecvMapped(MPI_Comm mpiComm, const bool isRdv, const int mbpr,
     eng.EndStep();
     auto end = std::chrono::steady_clock::now();
     std::chrono::duration<double> elapsed_seconds = end-start;
+    elapsed = elapsed_seconds.count();
     double min, max, avg;
-    timeMinMaxAvg(elapsed_seconds.count(), min, max, avg);
+    timeMinMaxAvg(mpiComm, elapsed_seconds.count(), min, max, avg);
     ss << " read";
     std::string str = ss.str();
     if(!rank) printTime(str, min, max, avg);
   }
+  return elapsed;
+}
+
+enum class Pattern { Mapped, FanOut };
+
+//the number of values each rank of comm sends to and receives from each rank
+//for the pattern; the first nproc-rdvRanks ranks are the non-rendezvous app
+void patternCounts(MPI_Comm comm, const Pattern pattern, const int mbpr,
+    const int rdvRanks, const int reductionFactor,
+    std::vector<int>& sendCounts, std::vector<int>& recvCounts) {
+  int rank, nproc;
+  MPI_Comm_rank(comm, &rank);
+  MPI_Comm_size(comm, &nproc);
+  const int numSenders = nproc - rdvRanks;
+  sendCounts.assign(nproc, 0);
+  recvCounts.assign(nproc, 0);
+  const bool isSender = rank < numSenders;
+  if(pattern == Pattern::Mapped) {
+    if(isSender)
+      sendCounts[numSenders + rank/reductionFactor] = mbpr;
+    else
+      for(int src=0; src<numSenders; src++)
+        if(src/reductionFactor == rank-numSenders) recvCounts[src] = mbpr;
+  } else {
+    const auto delta = mbpr/rdvRanks;
+    assert(delta*rdvRanks == mbpr);
+    if(isSender)
+      for(int dest=0; dest<rdvRanks; dest++) sendCounts[numSenders+dest] = delta;
+    else
+      for(int src=0; src<numSenders; src++) recvCounts[src] = delta;
+  }
+}
+
+//move the data of the pattern with MPI_Alltoallv, or MPI_Neighbor_alltoallv
+//over a graph of the ranks that communicate, and return the time of the last
+//of three exchanges
+double alltoallv(MPI_Comm comm, const Pattern pattern, const bool neighbor,
+    const int mbpr, const int rdvRanks, const int reductionFactor) {
+  int rank;
+  MPI_Comm_rank(comm, &rank);
+  std::vector<int> sendCounts, recvCounts;
+  patternCounts(comm, pattern, mbpr, rdvRanks, reductionFactor, sendCounts, recvCounts);
+  MPI_Comm graph = MPI_COMM_NULL;
+  if(neighbor) {
+    //keep only the ranks that communicate
+    std::vector<int> srcs, dests, nbrSendCounts, nbrRecvCounts;
+    for(int i=0; i<static_cast<int>(sendCounts.size()); i++) {
+      if(sendCounts[i]) { dests.push_back(i); nbrSendCounts.push_back(sendCounts[i]); }
+      if(recvCounts[i]) { srcs.push_back(i); nbrRecvCounts.push_back(recvCounts[i]); }
+    }
+    MPI_Dist_graph_create_adjacent(comm, srcs.size(), srcs.data(), MPI_UNWEIGHTED,
+        dests.size(), dests.data(), MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &graph);
+    sendCounts = std::move(nbrSendCounts);
+    recvCounts = std::move(nbrRecvCounts);
+  }
+  //the displacements are int, reject patterns whose totals don't fit
+  const auto sendTot = std::accumulate(sendCounts.begin(), sendCounts.end(), 0LL);
+  const auto recvTot = std::accumulate(recvCounts.begin(), recvCounts.end(), 0LL);
+  REDEV_ALWAYS_ASSERT(sendTot <= INT_MAX && recvTot <= INT_MAX);
+  std::vector<int> sendDispls(sendCounts.size()+1, 0);
+  std::vector<int> recvDispls(recvCounts.size()+1, 0);
+  for(size_t i=0; i<sendCounts.size(); i++) sendDispls[i+1] = sendDispls[i]+sendCounts[i];
+  for(size_t i=0; i<recvCounts.size(); i++) recvDispls[i+1] = recvDispls[i]+recvCounts[i];
+  redev::LOs msgs(sendDispls.back(), rank);
+  redev::LOs inMsgs(recvDispls.back());
+  const auto type = redev::getMpiType(redev::LO());
+
+  std::stringstream ss;
+  ss << mbpr << " B " << (pattern == Pattern::Mapped ? "mpiMapped" : "mpiFanOut")
+     << (neighbor ? " neighbor_alltoallv" : " alltoallv");
+  double elapsed = 0;
+  for(int i=0; i<3; i++) {
+    MPI_Barrier(comm);
+    auto start = std::chrono::steady_clock::now();
+    if(neighbor) {
+      MPI_Neighbor_alltoallv(msgs.data(), sendCounts.data(), sendDispls.data(), type,
+          inMsgs.data(), recvCounts.data(), recvDispls.data(), type, graph);
+    } else {
+      MPI_Alltoallv(msgs.data(), sendCounts.data(), sendDispls.data(), type,
+          inMsgs.data(), recvCounts.data(), recvDispls.data(), type, comm);
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double> elapsed_seconds = end-start;
+    elapsed = elapsed_seconds.count();
+    double min, max, avg;
+    timeMinMaxAvg(comm, elapsed, min, max, avg);
+    std::string str = ss.str();
+    if(!rank) printTime(str, min, max, avg);
+  }
+  if(graph != MPI_COMM_NULL)
+    MPI_Comm_free(&graph);
+  return elapsed;
+}
+
+//run the patterns and their MPI baselines in one job and print the ratios
+void sendRecvWithBaseline(const int mbpr, const int rdvRanks, const int reductionFactor) {
+  int rank, nprocs;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
+  assert(rdvRanks*(reductionFactor+1) == nprocs);
+  const bool isRdv = rank >= rdvRanks*reductionFactor;
+  MPI_Comm appComm;
+  MPI_Comm_split(MPI_COMM_WORLD, isRdv, rank, &appComm);
+  //the slowest rank of either application
+  auto maxTime = [](double time) {
+    double max = 0;
+    MPI_Allreduce(&time, &max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    return max;
+  };
+  const auto rdvMapped = maxTime(sendRecvRdvMapped(appComm, isRdv, mbpr, rdvRanks, reductionFactor));
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  const auto rdvFanOut = maxTime(sendRecvRdvFanOut(appComm, isRdv, mbpr, rdvRanks, reductionFactor));
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  bool isSST = false;
+  adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "2"}};
+  const auto mapped = maxTime(sendRecvMapped(appComm, isRdv, mbpr, rdvRanks, reductionFactor, isSST, params));
+  MPI_Comm_free(&appComm);
+  const auto mpiMapped = maxTime(alltoallv(MPI_COMM_WORLD, Pattern::Mapped, false, mbpr, rdvRanks, reductionFactor));
+  const auto nbrMapped = maxTime(alltoallv(MPI_COMM_WORLD, Pattern::Mapped, true, mbpr, rdvRanks, reductionFactor));
+  const auto mpiFanOut = maxTime(alltoallv(MPI_COMM_WORLD, Pattern::FanOut, false, mbpr, rdvRanks, reductionFactor));
+  const auto nbrFanOut = maxTime(alltoallv(MPI_COMM_WORLD, Pattern::FanOut, true, mbpr, rdvRanks, reductionFactor));
+  if(!rank) {
+    std::cout << mbpr << " B overhead ratio to alltoallv, neighbor_alltoallv (max time)\n";
+    auto printRatio = [](std::string mode, double time, double mpi, double nbr) {
+      std::cout << mode << " " << time/mpi << " " << time/nbr << "\n";
+    };
+    printRatio("mapped", mapped, mpiMapped, nbrMapped);
+    printRatio("rdvMapped", rdvMapped, mpiMapped, nbrMapped);
+    printRatio("rdvFanOut", rdvFanOut, mpiFanOut, nbrFanOut);
+  }
 }
 
 int main(int argc, char** argv) {
@@ -259,15 +406,39 @@ int main(int argc, char** argv) {
   int rank, nprocs;
   MPI_Comm_rank(MPI_COMM_WORLD, &rank);
   MPI_Comm_size(MPI_COMM_WORLD, &nprocs);
-  if(argc != 5) {
+  if(argc != 5 && argc != 4) {
     if(!rank) {
       std::cerr << "Usage: " << argv[0] << " <1=isRendezvousApp,0=isParticipant> <MBPR> <rdvRanks> <reductionFactor>\n";
+      std::cerr << "   or: " << argv[0] << " <MBPR> <rdvRanks> <reductionFactor>\n";
       std::cerr << "MBPR: millions of bytes per rank\n";
       std::cerr << "rdvRanks: number of ranks ran by the rendezvous app\n";
       std::cerr << "reductionFactor: ratio of rdvRanks to participant ranks, where participant ranks >> rdvRanks\n";
+      std::cerr << "the second form runs both apps in one job of rdvRanks*(reductionFactor+1) ranks\n"
+                << "and compares them to MPI_Alltoallv and MPI_Neighbor_alltoallv\n";
     }
     exit(EXIT_FAILURE);
   }
+  if(argc == 4) {
+    const long long mbprLL = atoll(argv[1])*MILLION;
+    assert(mbprLL>0);
+    auto rdvRanks = atoi(argv[2]);
+    assert(rdvRanks>0);
+    auto reductionFactor = atoi(argv[3]);
+    assert(reductionFactor>1);
+    //a rendezvous rank receives mbpr values from each of reductionFactor
+    //senders in the MPI baselines, their counts and displacements are int
+    if(mbprLL*reductionFactor > INT_MAX) {
+      if(!rank)
+        std::cerr << "MBPR*reductionFactor values exceed the int counts of MPI_Alltoallv, "
+                  << "reduce MBPR or reductionFactor\n";
+      MPI_Finalize();
+      exit(EXIT_FAILURE);
+    }
+    const auto mbpr = static_cast<int>(mbprLL);
+    sendRecvWithBaseline(mbpr, rdvRanks, reductionFactor);
+    MPI_Finalize();
+    return 0;
+  }
   auto isRdv = atoi(argv[1]);
   assert(isRdv==0 || isRdv ==1);
   auto mbpr = atoi(argv[2])*MILLION;
@@ -0,0 +1,260 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cassert>
+#include <algorithm>
+#include <chrono> //steady_clock, duration
+#include <map>
+#include <random>
+#include <sstream>
+#include "redev.h"
+#include "util_support.h"
+
+// send/recv parameter sweep
+// The non-rendezvous application sends to the rendezvous application for each
+// combination of transport, mode, message size, fan-out, and skew, and both
+// applications write one CSV row per step and phase with the min, max, and
+// average over their ranks of
+// - metadata: collectives and metadata reads in Send/Recv
+// - transfer: ADIOS2 Put/Get and PerformPuts/PerformGets
+// - step: BeginStep/EndStep, mostly waiting for the other application
+// - total: the whole communication phase
+// The first step includes variable definition and engine warm up; the later
+// steps give the steady state cost.
+//
+// The destinations of sender rank r, with R rendezvous ranks and fan-out f:
+// - uniform: ranks (r*f+k)%R for k in [0:f), equal sizes
+// - zipf: ranks 0 to f-1 for all senders, size of rank k proportional to
+//   1/(k+1)
+// - hotspot: the uniform ranks plus rank 0, which receives half the data
+//
+// The messages are compressed by the ADIOS2 operator of each entry of
+// --compressions, without a size threshold, so comparing the rows of
+// 'none' with those of an operator for increasing sizes gives the
+// break-even message size to set in redev::Compression::minBytes:
+// - none: no compression
+// - default: redev::DefaultCompression(), labeled none when the ADIOS2 build
+//   has no operator
+// - any other entry is passed as the ADIOS2 operator type, e.g., blosc
+// The payloads, from most to least compressible:
+// - constant: every item is the sender rank
+// - smooth: slowly increasing values, like a field ordered by locality
+// - random: uniformly distributed values, effectively incompressible
+
+namespace {
+  struct Options {
+    bool isRdv = false;
+    int rdvRanks = 0;
+    std::vector<std::string> transports{"bp4"};
+    std::vector<std::string> modes{"deferred"};
+    std::vector<size_t> sizes{1ULL<<20};
+    std::vector<int> fanouts{1};
+    std::vector<std::string> skews{"uniform"};
+    std::vector<std::string> compressions{"none"};
+    std::vector<std::string> payloads{"constant"};
+    int steps = 3;
+    std::string csv;
+  };
+
+  void usage(const char* exe) {
+    std::cerr << "Usage: " << exe << " <1=isRendezvousApp,0=isParticipant> <rdvRanks> [options]\n"
+              << "options, lists are comma separated:\n"
+              << "  --transports=bp4,sst   (default bp4)\n"
+              << "  --modes=deferred,sync  (default deferred)\n"
+              << "  --sizes=64K,1M,1G      bytes sent per rank (default 1M)\n"
+              << "  --fanouts=1,4          destinations per sender (default 1)\n"
+              << "  --skews=uniform,zipf,hotspot (default uniform)\n"
+              << "  --compressions=none,default,blosc,bzip2 (default none)\n"
+              << "  --payloads=constant,smooth,random (default constant)\n"
+              << "  --steps=3              steps per configuration (default 3)\n"
+              << "  --csv=file             write the rows to file instead of stdout\n";
+  }
+
+  Options parse(int argc, char** argv) {
+    Options opts;
+    if(argc < 3)
+      throw std::invalid_argument("missing arguments");
+    opts.isRdv = atoi(argv[1]);
+    opts.rdvRanks = atoi(argv[2]);
+    for(int i=3; i<argc; i++) {
+      const auto [key, value] = support::parseOption(argv[i]);
+      if(key == "transports") opts.transports = support::split(value);
+      else if(key == "modes") opts.modes = support::split(value);
+      else if(key == "skews") opts.skews = support::split(value);
+      else if(key == "compressions") opts.compressions = support::split(value);
+      else if(key == "payloads") opts.payloads = support::split(value);
+      else if(key == "steps") opts.steps = std::stoi(value);
+      else if(key == "csv") opts.csv = value;
+      else if(key == "sizes") opts.sizes = support::splitBytes(value);
+      else if(key == "fanouts") opts.fanouts = support::splitInts(value);
+      else throw std::invalid_argument(argv[i]);
+    }
+    return opts;
+  }
+
+  //destinations and CSR offsets of the message of one sender rank
+  void layout(int rank, int rdvRanks, int fanout, const std::string& skew,
+      size_t count, redev::LOs& dest, redev::LOs& offsets) {
+    fanout = std::min(fanout, rdvRanks);
+    std::map<redev::LO, double> weights;
+    if(skew == "uniform" || skew == "hotspot") {
+      for(int k=0; k<fanout; k++)
+        weights[(rank*fanout+k)%rdvRanks] = 1;
+      if(skew == "hotspot") {
+        weights.erase(0);
+        double rest = 0;
+        for(const auto& [d, w] : weights) rest += w;
+        weights[0] = std::max(rest, 1.0); //half the data
+      }
+    } else if(skew == "zipf") {
+      for(int k=0; k<fanout; k++)
+        weights[k] = 1.0/(k+1);
+    } else {
+      throw std::invalid_argument("unknown skew " + skew);
+    }
+    double total = 0;
+    for(const auto& [d, w] : weights) total += w;
+    dest.clear();
+    offsets.assign(1, 0);
+    size_t assigned = 0;
+    size_t i = 0;
+    for(const auto& [d, w] : weights) {
+      const bool last = ++i == weights.size();
+      const auto n = last ? count-assigned : static_cast<size_t>(count*w/total);
+      assigned += n;
+      dest.push_back(d);
+      offsets.push_back(static_cast<redev::LO>(assigned));
+    }
+  }
+
+  redev::Compression compression(const std::string& name) {
+    if(name == "none")
+      return {};
+    if(name == "default")
+      return redev::DefaultCompression(0);
+    redev::Compression c;
+    c.type = name;
+    c.minBytes = 0;
+    return c;
+  }
+
+  redev::LOs payload(const std::string& type, int rank, size_t count) {
+    redev::LOs msgs(count, rank);
+    if(type == "smooth") {
+      for(size_t i=0; i<count; i++)
+        msgs[i] = static_cast<redev::LO>(rank*count/16 + i/16);
+    } else if(type == "random") {
+      std::mt19937 gen(rank);
+      std::uniform_int_distribution<redev::LO> dist;
+      for(auto& m : msgs) m = dist(gen);
+    } else if(type != "constant") {
+      throw std::invalid_argument("unknown payload " + type);
+    }
+    return msgs;
+  }
+
+  void writeRow(std::ostream& os, const std::string& config, int step,
+      const char* phase, const redev::StatSummary& s) {
+    os << config << "," << step << "," << phase << ","
+       << s.min << "," << s.max << "," << s.avg << "\n";
+  }
+}
+
+void sweep(const Options& opts, std::ostream& csv) {
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  //the cuts won't be used since GetRank(...) won't be called
+  const auto dim = 2;
+  auto ptn = support::placeholderRCBPtn(dim, opts.rdvRanks);
+  redev::Redev rdv(MPI_COMM_WORLD, redev::Partition{std::move(ptn)},
+      static_cast<redev::ProcessType>(opts.isRdv));
+  int config = 0;
+  for(const auto& transport : opts.transports) {
+    const auto transportType = transport == "sst" ?
+      redev::TransportType::SST : redev::TransportType::BP4;
+    adios2::Params params{ {"Streaming", "On"}, {"OpenTimeoutSecs", "60"}};
+    auto channel = rdv.CreateAdiosChannel("sweep_" + transport, params, transportType);
+    for(const auto& modeName : opts.modes) {
+      const auto mode = modeName == "sync" ? redev::Mode::Synchronous : redev::Mode::Deferred;
+      for(const auto bytes : opts.sizes) {
+        for(const auto fanout : opts.fanouts) {
+          for(const auto& skew : opts.skews) {
+            for(const auto& compressionName : opts.compressions) {
+              for(const auto& payloadType : opts.payloads) {
+                const auto c = compression(compressionName);
+                //'default' falls back to no operator in some ADIOS2 builds
+                const auto compressionLabel =
+                  (compressionName == "default" && c.type.empty()) ? "none" : compressionName;
+                auto comm = channel.CreateComm<redev::LO>(
+                    "msgs" + std::to_string(config++), rdv.GetMPIComm(), c);
+                const auto count = bytes/sizeof(redev::LO);
+                redev::LOs msgs;
+                if(!opts.isRdv) {
+                  redev::LOs dest, offsets;
+                  layout(rank, opts.rdvRanks, fanout, skew, count, dest, offsets);
+                  comm.SetOutMessageLayout(dest, offsets);
+                  msgs = payload(payloadType, rank, count);
+                }
+                std::stringstream ss;
+                ss << (opts.isRdv ? "rdv" : "app") << "," << transport << ","
+                   << modeName << "," << bytes << "," << fanout << "," << skew
+                   << "," << compressionLabel << "," << payloadType;
+                for(int step=0; step<opts.steps; step++) {
+                  channel.ResetStats();
+                  MPI_Barrier(MPI_COMM_WORLD);
+                  auto start = std::chrono::steady_clock::now();
+                  if(!opts.isRdv) {
+                    channel.SendPhase([&]() { comm.Send(msgs.data(), mode); });
+                  } else {
+                    //deferred Recv fills the vector at EndStep, keep it past the phase
+                    const auto received =
+                        channel.ReceivePhase([&]() { return comm.Recv(mode); });
+                  }
+                  std::chrono::duration<double> total = std::chrono::steady_clock::now()-start;
+                  const auto report = redev::Report(channel.GetStats(), MPI_COMM_WORLD);
+                  const auto totalSummary = support::minMaxAvg(total.count());
+                  if(!rank) {
+                    writeRow(csv, ss.str(), step, "metadata", report.metadataSeconds);
+                    writeRow(csv, ss.str(), step, "transfer", report.transferSeconds);
+                    writeRow(csv, ss.str(), step, "step", report.stepSeconds);
+                    writeRow(csv, ss.str(), step, "total", totalSummary);
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int rank, nproc;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &nproc);
+  Options opts;
+  try {
+    opts = parse(argc, argv);
+  } catch(const std::exception& e) {
+    if(!rank) {
+      std::cerr << "Error: " << e.what() << "\n";
+      usage(argv[0]);
+    }
+    exit(EXIT_FAILURE);
+  }
+  REDEV_ALWAYS_ASSERT(opts.rdvRanks > 0);
+  REDEV_ALWAYS_ASSERT(!opts.isRdv || opts.rdvRanks == nproc);
+  REDEV_ALWAYS_ASSERT(opts.steps > 0);
+  std::ofstream csvFile;
+  if(!rank && !opts.csv.empty())
+    csvFile.open(opts.csv);
+  std::ostream& csv = opts.csv.empty() ? std::cout : csvFile;
+  if(!rank)
+    csv << "app,transport,mode,bytesPerRank,fanout,skew,compression,payload,step,phase,min,max,avg\n";
+
+  sweep(opts, csv);
+  MPI_Finalize();
+  return 0;
+}
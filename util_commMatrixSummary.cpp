@@ -0,0 +1,113 @@
+#include <iostream>
+#include <cstdlib>
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include "redev.h"
+
+// Summarize the communication matrices written with REDEV_COMM_MATRIX, see
+// redev_comm_matrix.h. For each communicator and step it prints
+// - the bytes sent
+// - the imbalance: the maximum bytes received by a rank over the average of
+//   the ranks that receive
+// - the maximum fan-in: the largest number of ranks sending to one rank
+// and, over all steps, the receivers with the most bytes.
+
+namespace {
+  template <typename T>
+  std::vector<T> readArray(adios2::IO& io, adios2::Engine& eng, const std::string& name) {
+    auto var = io.InquireVariable<T>(name);
+    std::vector<T> values;
+    if(!var) return values;
+    const auto shape = var.Shape();
+    if(shape.empty() || !shape[0]) return values;
+    var.SetSelection({{0}, {shape[0]}});
+    values.resize(shape[0]);
+    eng.Get(var, values.data());
+    return values;
+  }
+
+  struct StepSummary {
+    redev::GO bytes = 0;
+    std::map<redev::LO, redev::GO> received; //bytes per receiver
+    std::map<redev::LO, std::set<redev::LO>> senders; //senders per receiver
+  };
+}
+
+int main(int argc, char** argv) {
+  MPI_Init(&argc, &argv);
+  int rank;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  if(argc < 2 || argc > 3) {
+    if(!rank) {
+      std::cerr << "Usage: " << argv[0] << " <matrix.bp> [numHotReceivers=5]\n";
+      std::cerr << "matrix.bp: file written with REDEV_COMM_MATRIX set\n";
+    }
+    exit(EXIT_FAILURE);
+  }
+  const std::string path = argv[1];
+  const int numHot = argc == 3 ? atoi(argv[2]) : 5;
+  if(!rank) {
+    adios2::ADIOS adios(MPI_COMM_SELF);
+    auto io = adios.DeclareIO("redev communication matrix");
+    io.SetEngine("BP4");
+    auto eng = io.Open(path, adios2::Mode::Read);
+    REDEV_ALWAYS_ASSERT(eng);
+    auto status = eng.BeginStep();
+    REDEV_ALWAYS_ASSERT(status == adios2::StepStatus::OK);
+    std::string commNames;
+    if(auto var = io.InquireVariable<std::string>("comms"))
+      eng.Get(var, commNames);
+    const auto comm = readArray<redev::LO>(io, eng, "comm");
+    const auto step = readArray<redev::GO>(io, eng, "step");
+    const auto src = readArray<redev::LO>(io, eng, "src");
+    const auto dst = readArray<redev::LO>(io, eng, "dst");
+    const auto bytes = readArray<redev::GO>(io, eng, "bytes");
+    eng.PerformGets();
+    eng.EndStep();
+    eng.Close();
+    std::vector<std::string> names;
+    std::stringstream ss(commNames);
+    for(std::string name; std::getline(ss, name); )
+      names.push_back(name);
+
+    std::map<redev::LO, std::map<redev::GO, StepSummary>> summaries;
+    for(size_t i=0; i<comm.size(); i++) {
+      auto& s = summaries[comm[i]][step[i]];
+      s.bytes += bytes[i];
+      s.received[dst[i]] += bytes[i];
+      s.senders[dst[i]].insert(src[i]);
+    }
+    for(const auto& [c, steps] : summaries) {
+      const auto name = c < static_cast<redev::LO>(names.size()) ? names[c] : std::to_string(c);
+      std::cout << "communicator " << name << "\n";
+      std::cout << "  step bytes imbalance maxFanIn\n";
+      std::map<redev::LO, redev::GO> received;
+      for(const auto& [st, s] : steps) {
+        redev::GO maxRecv = 0;
+        size_t maxFanIn = 0;
+        for(const auto& [d, b] : s.received) {
+          maxRecv = std::max(maxRecv, b);
+          received[d] += b;
+        }
+        for(const auto& [d, srcs] : s.senders)
+          maxFanIn = std::max(maxFanIn, srcs.size());
+        const double avgRecv = static_cast<double>(s.bytes)/s.received.size();
+        std::cout << "  " << st << " " << s.bytes << " "
+                  << maxRecv/avgRecv << " " << maxFanIn << "\n";
+      }
+      std::vector<std::pair<redev::LO, redev::GO>> hot(received.begin(), received.end());
+      const auto n = std::min(static_cast<size_t>(numHot), hot.size());
+      std::partial_sort(hot.begin(), hot.begin()+n, hot.end(),
+          [](const auto& a, const auto& b) { return a.second > b.second; });
+      std::cout << "  hot receivers (rank bytes):";
+      for(size_t i=0; i<n; i++)
+        std::cout << " " << hot[i].first << " " << hot[i].second;
+      std::cout << "\n";
+    }
+  }
+  MPI_Finalize();
+  return 0;
+}
@@ -0,0 +1,188 @@
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Compare the CSV written by one of the benchmarks against a baseline CSV of
+// the same benchmark and fail if a configuration regressed by more than the
+// tolerance. The rows are grouped by the key columns; the best value of the
+// metric column in each group, over the repetitions or steps, is compared.
+// If the baseline file does not exist the results are copied to it and the
+// check passes, so the first run in a build directory caches the baseline.
+// Point the baseline to a file kept under version control to compare against
+// a fixed machine specific reference instead.
+
+namespace {
+  using Row = std::vector<std::string>;
+
+  std::vector<std::string> split(const std::string& str, char delim) {
+    std::vector<std::string> items;
+    std::stringstream ss(str);
+    for(std::string item; std::getline(ss, item, delim); )
+      items.push_back(item);
+    return items;
+  }
+
+  struct Options {
+    std::string results;
+    std::string baseline;
+    std::vector<std::string> keys;
+    std::string metric;
+    bool lowerIsBetter = true;
+    double tolerance = 0.5;
+    //column, value, and true for == or false for !=
+    std::vector<std::tuple<std::string, std::string, bool>> filters;
+  };
+
+  void usage(const char* exe) {
+    std::cerr << "Usage: " << exe << " <results.csv> <baseline.csv> --keys=col1,col2 --metric=col [options]\n"
+              << "options:\n"
+              << "  --better=lower|higher  direction of improvement of the metric (default lower)\n"
+              << "  --tolerance=0.5        allowed relative regression (default 0.5)\n"
+              << "  --filter=col=value     only compare rows matching, may be repeated\n"
+              << "  --filter=col!=value    only compare rows not matching, may be repeated\n";
+  }
+
+  Options parse(int argc, char** argv) {
+    if(argc < 3)
+      throw std::invalid_argument("missing arguments");
+    Options opts;
+    opts.results = argv[1];
+    opts.baseline = argv[2];
+    for(int i=3; i<argc; i++) {
+      const std::string arg = argv[i];
+      const auto eq = arg.find('=');
+      if(arg.rfind("--", 0) != 0 || eq == std::string::npos)
+        throw std::invalid_argument(arg);
+      const auto key = arg.substr(2, eq-2);
+      const auto value = arg.substr(eq+1);
+      if(key == "keys") opts.keys = split(value, ',');
+      else if(key == "metric") opts.metric = value;
+      else if(key == "better") opts.lowerIsBetter = value != "higher";
+      else if(key == "tolerance") opts.tolerance = std::stod(value);
+      else if(key == "filter") {
+        const auto ne = value.find("!=");
+        const auto e = value.find('=');
+        if(ne != std::string::npos)
+          opts.filters.emplace_back(value.substr(0, ne), value.substr(ne+2), false);
+        else if(e != std::string::npos)
+          opts.filters.emplace_back(value.substr(0, e), value.substr(e+1), true);
+        else
+          throw std::invalid_argument(arg);
+      }
+      else throw std::invalid_argument(arg);
+    }
+    if(opts.keys.empty() || opts.metric.empty())
+      throw std::invalid_argument("--keys and --metric are required");
+    return opts;
+  }
+
+  std::size_t column(const Row& header, const std::string& name, const std::string& path) {
+    const auto it = std::find(header.begin(), header.end(), name);
+    if(it == header.end())
+      throw std::runtime_error(path + " has no column " + name);
+    return it - header.begin();
+  }
+
+  //best metric value of each group of rows with the same key columns
+  std::map<std::string, double> read(const std::string& path, const Options& opts) {
+    std::ifstream file(path);
+    if(!file.is_open())
+      throw std::runtime_error("cannot open " + path);
+    std::string line;
+    std::getline(file, line);
+    const auto header = split(line, ',');
+    std::vector<std::size_t> keyCols;
+    for(const auto& key : opts.keys)
+      keyCols.push_back(column(header, key, path));
+    const auto metricCol = column(header, opts.metric, path);
+    std::vector<std::tuple<std::size_t, std::string, bool>> filters;
+    for(const auto& [col, value, equal] : opts.filters)
+      filters.emplace_back(column(header, col, path), value, equal);
+
+    std::map<std::string, double> best;
+    while(std::getline(file, line)) {
+      auto row = split(line, ',');
+      row.resize(header.size());
+      const bool skip = std::any_of(filters.begin(), filters.end(), [&](const auto& f) {
+        return (row[std::get<0>(f)] == std::get<1>(f)) != std::get<2>(f);
+      });
+      if(skip)
+        continue;
+      std::string key;
+      for(const auto c : keyCols)
+        key += (key.empty() ? "" : ",") + row[c];
+      const auto value = std::stod(row[metricCol]);
+      const auto [it, inserted] = best.emplace(key, value);
+      if(!inserted)
+        it->second = opts.lowerIsBetter ? std::min(it->second, value) : std::max(it->second, value);
+    }
+    return best;
+  }
+}
+
+int main(int argc, char** argv) {
+  Options opts;
+  try {
+    opts = parse(argc, argv);
+  } catch(const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  if(!std::ifstream(opts.baseline).good()) {
+    std::ifstream in(opts.results);
+    std::ofstream out(opts.baseline);
+    if(!in.is_open() || !(out << in.rdbuf())) {
+      std::cerr << "Error: cannot copy " << opts.results << " to " << opts.baseline << "\n";
+      return EXIT_FAILURE;
+    }
+    std::cout << "no baseline, " << opts.results << " copied to " << opts.baseline << "\n";
+    return EXIT_SUCCESS;
+  }
+  std::map<std::string, double> results, baseline;
+  try {
+    results = read(opts.results, opts);
+    baseline = read(opts.baseline, opts);
+  } catch(const std::exception& e) {
+    std::cerr << "Error: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+  if(results.empty()) {
+    std::cerr << "Error: no rows to compare in " << opts.results << "\n";
+    return EXIT_FAILURE;
+  }
+  //ratio above one is a regression
+  int regressions = 0;
+  std::cout << std::setw(12) << "baseline" << std::setw(12) << "result"
+            << std::setw(10) << "ratio" << "  " << opts.metric << " of ";
+  for(const auto& key : opts.keys)
+    std::cout << key << (&key == &opts.keys.back() ? "\n" : ",");
+  for(const auto& [key, value] : results) {
+    const auto it = baseline.find(key);
+    if(it == baseline.end()) {
+      std::cout << std::setw(12) << "-" << std::setw(12) << value
+                << std::setw(10) << "-" << "  " << key << " (not in baseline)\n";
+      continue;
+    }
+    const double ratio = opts.lowerIsBetter ? value/it->second : it->second/value;
+    const bool regressed = ratio > 1 + opts.tolerance;
+    regressions += regressed;
+    std::cout << std::setw(12) << it->second << std::setw(12) << value
+              << std::setw(10) << ratio << "  " << key
+              << (regressed ? " REGRESSION" : "") << "\n";
+  }
+  if(regressions) {
+    std::cout << regressions << " configurations regressed by more than "
+              << 100*opts.tolerance << "%\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
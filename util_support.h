@@ -1,6 +1,11 @@
 #pragma once
 #include <adios2.h>
+#include <mpi.h>
 #include <string>
+#include <sstream>
+#include <stdexcept>
+#include <utility> //pair
+#include <vector>
 #include <cassert>
 
 namespace support{
@@ -29,5 +34,72 @@ namespace support{
       assert(c2sEngine);
     }
   }
+
+  //Partition for benchmarks that never call GetRank(...). RCBPtn requires a
+  //power of two number of parts so the rendezvous ranks are padded up to one.
+  redev::RCBPtn placeholderRCBPtn(int dim, int rdvRanks) {
+    size_t parts = 1;
+    while(parts < static_cast<size_t>(rdvRanks)) parts *= 2;
+    auto ranks = redev::LOs(parts);
+    auto cuts = redev::Reals(parts);
+    return redev::RCBPtn(dim,ranks,cuts);
+  }
+
+  //split a comma separated list
+  std::vector<std::string> split(const std::string& str) {
+    std::vector<std::string> items;
+    std::stringstream ss(str);
+    for(std::string item; std::getline(ss, item, ','); )
+      items.push_back(item);
+    return items;
+  }
+
+  template <typename T = int>
+  std::vector<T> splitInts(const std::string& str) {
+    std::vector<T> values;
+    for(const auto& s : split(str))
+      values.push_back(static_cast<T>(std::stoll(s)));
+    return values;
+  }
+
+  //e.g., 512, 64K, 16M, 2G
+  size_t parseBytes(const std::string& str) {
+    size_t scale = 1;
+    switch(str.back()) {
+      case 'K': case 'k': scale = 1ULL<<10; break;
+      case 'M': case 'm': scale = 1ULL<<20; break;
+      case 'G': case 'g': scale = 1ULL<<30; break;
+    }
+    return std::stoull(scale > 1 ? str.substr(0, str.size()-1) : str)*scale;
+  }
+
+  std::vector<size_t> splitBytes(const std::string& str) {
+    std::vector<size_t> values;
+    for(const auto& s : split(str))
+      values.push_back(parseBytes(s));
+    return values;
+  }
+
+  //split an option of the form --key=value into its key and value
+  std::pair<std::string, std::string> parseOption(const std::string& arg) {
+    const auto eq = arg.find('=');
+    if(arg.rfind("--", 0) != 0 || eq == std::string::npos)
+      throw std::invalid_argument(arg);
+    return {arg.substr(2, eq-2), arg.substr(eq+1)};
+  }
+
+  //min, max, and average of value over the ranks of MPI_COMM_WORLD
+  redev::StatSummary minMaxAvg(double value) {
+    const auto comm = MPI_COMM_WORLD;
+    int nproc;
+    MPI_Comm_size(comm, &nproc);
+    redev::StatSummary s;
+    double tot = 0;
+    MPI_Allreduce(&value, &s.min, 1, MPI_DOUBLE, MPI_MIN, comm);
+    MPI_Allreduce(&value, &s.max, 1, MPI_DOUBLE, MPI_MAX, comm);
+    MPI_Allreduce(&value, &tot, 1, MPI_DOUBLE, MPI_SUM, comm);
+    s.avg = tot / nproc;
+    return s;
+  }
 } //end anonymous namespace
 